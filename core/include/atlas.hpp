@@ -0,0 +1,72 @@
+#ifndef ATLAS_HPP_
+#define ATLAS_HPP_
+
+#include <vector>
+#include <algorithm>
+#include <stdexcept>
+#include <glm/glm.hpp>
+
+/* struct AtlasRegion
+   Rectangle of texture space that an image was packed into, in the units of Frame and Quad texture values.
+   - texpos - position of the rectangle's upper left corner in its layer, and the layer
+   - texsize - width and height of the rectangle
+*/
+struct AtlasRegion {
+    glm::vec3 texpos;
+    glm::vec2 texsize;
+};
+
+/* class Atlas
+   Packs rectangles into the layers of a texture space, using a skyline per layer: the free space of a layer is
+   tracked as the lowest free row of each horizontal segment, and each rectangle is placed at the position where
+   its bottom edge ends up highest (then leftmost), in the first layer where it fits. Layers can be reserved
+   to exclude them from packing (e.g. when their contents are placed manually).
+*/
+class Atlas {
+    // horizontal segment of a layer's skyline; rows above y are occupied from x to x + width
+    struct Segment {
+        unsigned x;
+        unsigned y;
+        unsigned width;
+    };
+
+    // skyline of each layer (empty if reserved)
+    std::vector<std::vector<Segment>> _skylines;
+    unsigned _width;
+    unsigned _height;
+
+    // returns whether a rectangle fits with its left edge at the start of a skyline segment, and the row it fits at
+    bool _fit(const std::vector<Segment> &skyline, unsigned index, unsigned width, unsigned height, unsigned &y);
+
+    // raises the skyline where a rectangle was placed, at the start of a skyline segment
+    void _place(std::vector<Segment> &skyline, unsigned index, unsigned y, unsigned width, unsigned height);
+
+public:
+    /* Calls reset() with the provided arguments. */
+    Atlas(unsigned width, unsigned height, unsigned depth);
+    Atlas();
+    ~Atlas();
+
+    // default copy assignment/construction are fine
+
+    /* Empties the atlas, and sets the size of the texture space to pack into.
+       width - width of each layer
+       height - height of each layer
+       depth - number of layers
+    */
+    void reset(unsigned width, unsigned height, unsigned depth);
+
+    /* Excludes a layer from packing. */
+    void reserveLayer(unsigned layer);
+
+    /* Finds space for a rectangle of the provided size, marks it as used, and returns it. Throws if no layer
+       has enough free space.
+    */
+    AtlasRegion pack(unsigned width, unsigned height);
+
+    unsigned width();
+    unsigned height();
+    unsigned depth();
+};
+
+#endif
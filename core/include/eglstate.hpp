@@ -0,0 +1,67 @@
+#ifndef EGLSTATE_HPP_
+#define EGLSTATE_HPP_
+
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#include <cstring>
+#include <iostream>
+#include "glutil.hpp"
+
+/* class EGLErrorException
+   This exception is thrown when an EGL call fails while setting up an EGLState.
+*/
+class EGLErrorException : public std::runtime_error {
+public:
+   EGLErrorException(const char *call);
+};
+
+/* class EGLState
+   Headless counterpart of GLFWState: wraps an EGL display and an OpenGL core context (4.6, or 4.5 if unsupported)
+   that is not tied to a window, so that rendering can run without a display (e.g. benchmarks and tests on build 
+   agents with Mesa's llvmpipe). The surfaceless platform is used if available (EGL_MESA_platform_surfaceless), and 
+   the context is made current without a surface if supported (EGL_KHR_surfaceless_context), or with a pbuffer 
+   surface otherwise. Displays without pbuffer configurations (such as the surfaceless platform) need
+   EGL_KHR_no_config_context.
+
+   As a surfaceless context has no window framebuffer, initTarget() sets up an offscreen framebuffer of the
+   provided size to stand in for it (see GLUtil::setDefaultFramebuffer()), so that rendering code written for a
+   window runs unchanged. On Linux, GLEW must be built with EGL support (GLEW_EGL) for GLUtil::glinit() to
+   load OpenGL functions from an EGL context.
+
+   Only available when the core library is built with HEADLESS=1.
+*/
+class EGLState {
+   EGLDisplay _display;
+   EGLContext _context;
+   EGLSurface _surface;
+   GLUtil::GLFramebuffer _target;
+   int _width;
+   int _height;
+
+public:
+   EGLState(int width, int height, bool debug);
+   EGLState();
+   ~EGLState();
+   EGLState(const EGLState &other) = delete;
+   EGLState &operator=(const EGLState &other) = delete;
+
+   /* Initializes EGL and creates a context with the provided target size, and makes it current. */
+   void init(int width, int height, bool debug);
+   void uninit();
+
+   /* Creates the offscreen framebuffer standing in for the window's framebuffer. Must be called after
+      GLUtil::glinit(). */
+   void initTarget();
+
+   /* Blocks until all issued OpenGL commands have completed, in place of swapping buffers, so that the time
+      taken to render frames can be measured. */
+   void finish();
+
+   /* Returns the offscreen framebuffer standing in for the window's framebuffer (e.g. to read back pixels). */
+   GLUtil::GLFramebuffer &getTarget();
+
+   /* Returns whether the context has no surface (and thus needs the offscreen framebuffer to be drawn into). */
+   bool isSurfaceless();
+};
+
+#endif
@@ -23,6 +23,8 @@ class Entity : public Script {
    void _init() override;
    void _base() override;
    void _kill() override;
+   void _reset() override;
+   void _release() override;
 
 protected:
    /* Functions to be overridden by children.
@@ -33,6 +35,10 @@ protected:
    virtual void _initEntity() = 0;
    virtual void _baseEntity() = 0;
    virtual void _killEntity() = 0;
+   // called by _reset(), when the Entity is respawned after being recycled; does nothing by default
+   virtual void _resetEntity();
+   // called by _release(), when the recycled Entity is handed back to its allocator; does nothing by default
+   virtual void _releaseEntity();
 
 public:
    Entity(Entity &&other);
@@ -70,33 +76,29 @@ class GenericEntityAllocator : public EntityAllocatorInterface {
    Entity *_allocate(int tag) override { return new T; } 
 };
 
+/* class PooledEntityAllocator
+   An implementation of the EntityAllocatorInterface that allocates instances from a SlabPool (see
+   PooledAllocator).
+*/
+template<class T>
+class PooledEntityAllocator : public EntityAllocatorInterface {
+   SlabPool<T> _pool;
+   Entity *_allocate(int tag) override { return _pool.alloc(); }
+   void _deallocate(Script *script) override { _pool.free(static_cast<T*>(script)); }
+};
+
 // --------------------------------------------------------------------------------------------------------------------------
 
 class EntityExecutor : public Executor {
-   // struct holding Entity information mapped to a name
+   // struct holding Entity information of an added name, indexed by ScriptType (null allocator for plain Scripts)
    struct EntityInfo {
       EntityAllocatorInterface *_allocator;
       // default copy assignment/construction are fine
    };
 
-protected:
-   // class to store enqueues and polymorphically spawn later
-   class EntityEnqueue : public ScriptEnqueue {
-      friend EntityExecutor;
-      EntityExecutor *_entityexecutor;
-   
-   protected:
-      Transform _transform;
-      
-      // invokes the containing EntityExecutor's _spawnEntity() method and returns the spawned instance's reference
-      virtual Entity *spawn() override;
-      EntityEnqueue(EntityExecutor *entityexecutor, std::string name, int execution_queue, int tag, Transform transform);
-      // default copy assignment/construction are fine (copying implies another enqueue in the same EntityExecutor)
-   };
-
-private:
-   // internal variables for added Entity information and enqueued Entities
-   std::unordered_map<std::string, EntityInfo> _entityinfos;
+   // internal variables for added Entity information, and Transforms of enqueued Entities (indexed by spawn record)
+   std::vector<EntityInfo> _entityinfos;
+   std::vector<Transform> _spawntransforms;
 
    GLEnv *_glenv;
    unordered_map_string_Animation_t *_animations;
@@ -106,10 +108,14 @@ private:
 
 protected:
    // initializes Entity's EntityExecutor-related fields
-   void _setupEntity(Entity *entity, const char *entity_name);
+   void _setupEntity(Entity *entity);
+
+   // spawns an Entity of a type previously added to this EntityExecutor
+   Entity *_spawnEntity(ScriptType type, int execution_queue, int tag, Transform transform);
 
-   // spawns an Entity using a name previously added to this EntityExecutor
-   Entity *_spawnEntity(const char *entity_name, int execution_queue, int tag, Transform transform);
+   // spawns Entities with their recorded Transforms, and other Scripts as Executor does
+   Script *_spawnRecord(const SpawnRecord &record) override;
+   void _clearSpawnRecords() override;
     
 public:
    /* Calls init() with the provided arguments. */
@@ -136,10 +142,12 @@ public:
       - removeonkill - removes this Entity from this manager when it is killed
       - spawn_callback - function callback to call after Entity has been spawned and setup
       - remove_callback - function callback to call before Entity has been removed
+      Returns a handle to the name that can be used to spawn the Entity without looking up the name.
    */
-   void addEntity(EntityAllocatorInterface *allocator, const char *name, int group, bool removeonkill, std::function<void(Script*)> spawn_callback, std::function<void(Script*)>  remove_callback);
+   ScriptType addEntity(EntityAllocatorInterface *allocator, const char *name, int group, bool removeonkill, std::function<void(Script*)> spawn_callback, std::function<void(Script*)>  remove_callback);
 
    /* Enqueues an Entity to be spawned when calling runSpawnQueue(). */
+   void enqueueSpawnEntity(ScriptType type, int execution_queue, int tag, Transform transform);
    void enqueueSpawnEntity(const char *entity_name, int execution_queue, int tag, Transform transform);
 
    GLEnv &glenv();
@@ -158,6 +166,8 @@ public:
 template<class T>
 class ProvidedEntityAllocator : public ProvidedAllocator<T>, public EntityAllocatorInterface {
    Entity *_allocate(int tag) override { return this->_allocateStore(tag); }
+   void _deallocate(Script *script) override { this->_deallocateProvided(static_cast<T*>(script)); }
+   void _reuse(Script *script, int tag) override { this->_reuseStore(static_cast<T*>(script), tag); }
 protected:
    virtual T *_allocateProvided() override = 0;
 };
@@ -1,60 +1,155 @@
 #ifndef GLENV_HPP_
 #define GLENV_HPP_
 
+#include <algorithm>
+#include <deque>
+#include <unordered_map>
+
 #include "util.hpp"
 #include "glutil.hpp"
 #include "animation.hpp"
+#include "atlas.hpp"
+
+// prototype
+class GLEnv;
 
 /* class Quad
    Encapsulates Quad-like data for OpenGL environments.
-   Uses BVec instances to store basic parameters of quads:
+   Acts as a view into the shadow arrays of its owning GLEnv, which store the basic parameters of quads
+   at the Quad's current slot:
 
    - position - location of quad in 3D space
    - scale - values to scale width, height and depth of unit quad
    - color - hue to apply to quad
    - texture position - UV coordinates to use in texture space
    - texture size - width and height of texture to use, applied to UV coordinates to get rectangle
+
+   Values written through a Quad are written into graphic memory by the owning GLEnv's update() method.
 */
 class Quad {
+   friend GLEnv;
+
+   // owning environment and offset of this Quad in it (remapped to a slot of its shadow arrays)
+   GLEnv *_glenv;
+   unsigned _offset;
+
    bool _first_step;
 
    // controllable variables
    AnimationState _animationstate;
 
+   // returns the slot of the owning GLEnv's shadow arrays currently holding this Quad's values
+   unsigned _slot();
+
 public:
-/* BVecs containing references to Quad's associated OpenGL buffers */
-   GLUtil::BVec3 bv_pos;
-   GLUtil::BVec3 bv_scale;
-   GLUtil::BVec4 bv_color;
-   GLUtil::BVec3 bv_texpos;
-   GLUtil::BVec2 bv_texsize;
-   /* position - location of quad in 3D space
-      scale - scaling values for x, y, and z coordinates of quad vertices
-      color - color to apply to quad
-      textureposition - UV coordinates to use in texture space
-      texturesize - width and height of texture to use, applied to UV coordinates to get rectangle 
-   */
-   Quad(GLUtil::BVec3 position, GLUtil::BVec3 scale, GLUtil::BVec4 color, GLUtil::BVec3 textureposition, GLUtil::BVec2 texturesize);
+   Quad(GLEnv *glenv, unsigned offset);
    Quad();
    ~Quad();
 
    // default copy assignment/construction are fine
 
-   /* Calls update() on all internal BVec instances, writing their respective data into their respective buffers. */
-   void update();
+   /* Getters and setters for the Quad's values in the owning GLEnv. Setting a value different from the
+      current one marks it to be written by the next GLEnv::update().
+      position - location of quad in 3D space
+      scale - scaling values for x, y, and z coordinates of quad vertices
+      color - color to apply to quad
+      texture position - UV coordinates to use in texture space
+      texture size - width and height of texture to use, applied to UV coordinates to get rectangle 
+   */
+   const glm::vec3 &getPos();
+   const glm::vec3 &getScale();
+   const glm::vec4 &getColor();
+   const glm::vec3 &getTexPos();
+   const glm::vec2 &getTexSize();
+   void setPos(glm::vec3 pos);
+   void setScale(glm::vec3 scale);
+   void setColor(glm::vec4 color);
+   void setTexPos(glm::vec3 texpos);
+   void setTexSize(glm::vec2 texsize);
 
-   /* Sets internal Animation state to use provided Animation, to write to texpos and texsize BVecs. */
+   /* Sets internal Animation state to use provided Animation, to write to texture position and texture size. With 
+      GLE_GPU_ANIM, the Animation must be one passed to the owning GLEnv's setAnimations(), and the Quad instead starts 
+      playing it in graphic memory from the current tick (see GLEnv::stepAnims()). */
    void setAnim(Animation *animation);
 
-   /* Returns reference to contained Animation state. */
+   /* Sets the cycle of the Animation to play, restarting it if different from the current one. */
+   void setCycle(unsigned cycle);
+
+   /* Returns reference to contained Animation state (not stepped with GLE_GPU_ANIM). */
    AnimationState &animationstate();
 
-   /* Steps animation, if one is contained */
+   /* Steps animation, if one is contained (does nothing with GLE_GPU_ANIM, as frames are resolved by the vertex shader) */
    void stepAnim();
+
+   /* Returns the offset of this Quad in its owning GLEnv. */
+   unsigned getOffset();
 };
 
 enum DrawType { GLE_RECT, GLE_ELLIPSE };
 
+// number of DrawType values
+#define GLENV_DRAWTYPE_COUNT 2
+
+/* Flags controlling how a GLEnv manages its instance data (see GLEnv::init()).
+   - GLE_PERSISTENT - allocates the position, scale, color, texture position and texture size buffers
+     with immutable storage and keeps them persistently mapped, split into GLENV_RING_SIZE regions. Each
+     frame writes into the next region, and fences ensure the GPU is done reading a region before it is
+     written again; uploads become plain memory copies instead of OpenGL calls.
+   - GLE_SHRINK - halves the capacity of the instance buffers (down to the initial capacity) once no more
+     than a quarter of it has been in use for GLENV_SHRINK_UPDATES consecutive update() calls.
+   - GLE_PACKED - stores instance data quantized in graphic memory (28 instead of 64 bytes per Quad): position 
+     and scale as 16 bit fixed point values with 1 / GLENV_PACKED_SUBPIXEL precision (range of about 
+     [-32768, 32767] / GLENV_PACKED_SUBPIXEL, and no z scale), color as 8 bit normalized values in [0, 1], and 
+     texture position and size as 16 bit unsigned integers. Values outside these ranges are clamped.
+   - GLE_OFFSCREEN - renders into an offscreen framebuffer at pixel space resolution (see setPixelSpace()), which
+     drawQuads() clears before drawing and then upscales to window space with nearest filtering, replacing the 
+     window's contents. Fragment work is reduced by the square of the scale factor, and ellipses are computed
+     from interpolated coordinates instead of from window coordinates.
+   - GLE_GPU_ANIM - evaluates Animations in the vertex shader. All Animation data is written into shader storage 
+     once (see setAnimations()), and animated Quads only store a record of their Animation, cycle and starting tick; 
+     their texture position, texture size and scale are resolved from the global tick (see stepAnims()) instead of 
+     being stepped and written per Quad.
+   - GLE_LAYERED - draws every Quad with a single indirect multi draw call, using one program for both draw types
+     (selected per Quad by an additional per instance attribute). Quads are bucketed by layer (z position) and 
+     opacity instead of by draw type: opaque layers (color alpha of 1) are ordered front to back, so that depth 
+     testing rejects hidden fragments early, followed by translucent layers (color alpha below 1) ordered back to 
+     front and blended by alpha. Fragments with an alpha of 0 (e.g. transparent texels) are discarded. Depth 
+     testing must be enabled for layers to be resolved as before.
+*/
+enum GLEnvFlag { 
+   GLE_NONE = 0x0, GLE_PERSISTENT = 0x1, GLE_SHRINK = 0x2, GLE_PACKED = 0x4, GLE_OFFSCREEN = 0x8, GLE_GPU_ANIM = 0x10, 
+   GLE_LAYERED = 0x20 
+};
+
+// number of regions persistently mapped buffers are split into
+#define GLENV_RING_SIZE 3
+
+// maximum number of clean instances between two dirty ranges for them to be merged into one upload
+#define GLENV_COALESCE_GAP 8
+
+// fixed point scale of positions and scales (with GLE_PACKED)
+#define GLENV_PACKED_SUBPIXEL 4
+
+// number of consecutive update() calls with low usage before capacity is shrunk (with GLE_SHRINK)
+#define GLENV_SHRINK_UPDATES 600
+
+// minimum size of the buffer texture data is streamed through, in bytes
+#define GLENV_UNPACK_SIZE (16 * 1024 * 1024)
+
+// number of segments the texture streaming buffer is split into, each guarded by its own fence
+#define GLENV_UNPACK_SEGMENTS 4
+
+/* struct GLEnvStats
+   Counters describing the work done by the last GLEnv::update() call.
+   - upload_bytes - number of bytes written into instance buffers
+   - upload_ranges - number of contiguous ranges written (one write call each)
+*/
+struct GLEnvStats {
+   unsigned upload_bytes = 0;
+   unsigned upload_ranges = 0;
+   // default copy assignment/construction are fine
+};
+
 /* class GLEnv
    Encapsulates all OpenGL environment related data and methods. 
    Currently restricted to draw Quads with a simple fragment shader and vertex shader, and parameterized
@@ -65,22 +160,47 @@ enum DrawType { GLE_RECT, GLE_ELLIPSE };
    - Quad color (vec4)
    - Quad texture position (vec3) (multi-level 2D texture space)
    - Quad texture size (vec2) (added to positions to get a rectangle)
-   - Quad drawtype (float) (describes to shader whether to render Quad as a rectangle or ellipse)
-   - Quad drawing flag (float) (modified by GLEnv instance)
+   - Quad drawtype (whether to render Quad as a rectangle or ellipse)
+
+   The initial capacity of the instance buffers can be specified. When more Quads are generated than fit,
+   the capacity is doubled; the buffers are reallocated and their contents copied on the GPU. Quad offsets
+   and Quad pointers remain valid across reallocations.
 
-   The maximum amount of Quads allowed by the system can be specified. This also
-   guarantees that no more than max_count IDs will be generated and tracked. The environment will
-   throw an exception if more than the allowed amount is generated.
+   Active Quads are kept densely packed in the first slots of the instance buffers, so that only
+   active Quads are drawn. Quad offsets are stable handles, remapped to their current slot internally.
+   Slots are bucketed by draw type into contiguous ranges, each drawn with a separate shader program
+   specialized for the type (ellipses do not read texture attributes), or with GLE_LAYERED, by layer and
+   opacity into ranges in drawing order, all drawn with a single call.
 
    It is undefined behavior to make method calls (except for uninit()) on instances 
    of this class without calling init() first.
 */
 class GLEnv {
+   friend Quad;
+
+   // indices of per instance attributes with shadow arrays (animation records only exist with GLE_GPU_ANIM, and draw
+   // types only with GLE_LAYERED)
+   enum Attrib { ATTRIB_POS, ATTRIB_SCALE, ATTRIB_COLOR, ATTRIB_TEXPOS, ATTRIB_TEXSIZE, ATTRIB_ANIM, ATTRIB_TYPE, ATTRIB_COUNT };
+
+   // sort key of a bucket of slots: the draw type and 0, or with GLE_LAYERED, the opacity class (0 for opaque) and the 
+   // z position, negated for opaque layers so that they are drawn front to back
+   typedef std::pair<unsigned, float> BucketKey;
+
    /* environment structures */
-   // shader program structure
-   GLUtil::GLStage _stage;
-   // texture array structure
+   // shader program structures, indexed by DrawType (only the first is used with GLE_LAYERED, for both types)
+   GLUtil::GLStage _stages[GLENV_DRAWTYPE_COUNT];
+   // texture array structure, and packing of its space
    GLUtil::GLTexture2DArray _texarray;
+   Atlas _atlas;
+   // persistently mapped buffer texture data is streamed through, next offset to write into, fences placed after
+   // the last upload from each segment, and segment last written into (-1 if none since wrapping around)
+   GLUtil::GLBuffer _glb_unpack;
+   unsigned _unpack_offset;
+   GLUtil::GLFence _unpack_fences[GLENV_UNPACK_SEGMENTS];
+   int _unpack_segment;
+   // render target at pixel space resolution, and window size to upscale it to (with GLE_OFFSCREEN)
+   GLUtil::GLFramebuffer _framebuffer;
+   glm::uvec2 _windowspace;
 
    /* model data buffers */
    // model to be used per instance
@@ -88,36 +208,152 @@ class GLEnv {
    // position elements of model
    GLUtil::GLBuffer _glb_elembuf;
 
-   /* per instance data buffers */
-   // position of instance
-   GLUtil::GLBuffer _glb_pos;
-   // scale of instance
-   GLUtil::GLBuffer _glb_scale;
-   // color of instance
-   GLUtil::GLBuffer _glb_color;
-   // texture position of instance
-   GLUtil::GLBuffer _glb_texpos;
-   // texture size of instance
-   GLUtil::GLBuffer _glb_texsize;
-   // whether to interpret data as a rectangle or ellipse
-   GLUtil::GLBuffer _glb_type;
-   // whether instance should be drawn or zeroed out
-   GLUtil::GLBuffer _glb_draw;
+   /* per instance data buffers, indexed by Attrib (position, scale, color, texture position, texture size, animation, 
+      draw type) */
+   GLUtil::GLBuffer _glb_attribs[ATTRIB_COUNT];
+
+   /* layered drawing (with GLE_LAYERED) */
+   // draw commands of each bucket, and whether buckets changed since the commands were last written
+   GLUtil::GLBuffer _glb_indirect;
+   std::vector<GLUtil::GLDrawCommand> _commands;
+   bool _buckets_changed;
+
+   /* animation data (with GLE_GPU_ANIM) */
+   // shader storage buffers of all cycles and frames
+   GLUtil::GLBuffer _glb_cycles;
+   GLUtil::GLBuffer _glb_frames;
+   // index of the first cycle of each Animation in the cycle buffer
+   std::unordered_map<const Animation*, unsigned> _anim_cycles;
+   // current tick, that animation records are started at
+   unsigned _tick;
+
+   /* persistent mapping state */
+   // fences placed after drawing from each region, and region currently being written
+   GLUtil::GLFence _fences[GLENV_RING_SIZE];
+   unsigned _ring_index;
+
+   /* per instance shadow arrays, indexed by slot and uploaded in bulk by update() */
+   std::vector<glm::vec3> _pos;
+   std::vector<glm::vec3> _scale;
+   std::vector<glm::vec4> _color;
+   std::vector<glm::vec3> _texpos;
+   std::vector<glm::vec2> _texsize;
+   // first cycle of Animation, cycle within it, starting tick, and whether animated (with GLE_GPU_ANIM)
+   std::vector<glm::uvec4> _anim;
+   // draw type (only written into graphic memory with GLE_LAYERED)
+   std::vector<GLuint> _type;
+
+   /* dense packing of active Quads */
+   // slot of each Quad offset (indexed by offset), and Quad offset held by each slot (indexed by slot)
+   std::vector<unsigned> _slots;
+   std::vector<unsigned> _slot_offsets;
+   // first offset of the range each Quad offset was generated in by genQuads() (indexed by offset)
+   std::vector<unsigned> _ranges;
+   // key and first slot of each non empty bucket, sorted by key (a bucket ends where the next begins, and the last at 
+   // the active count)
+   std::vector<BucketKey> _bucket_keys;
+   std::vector<unsigned> _bucket_begin;
+
+   /* dirty tracking of shadow arrays */
+   // per attribute and slot, number of buffer regions the value must still be written into
+   std::vector<unsigned char> _dirty[ATTRIB_COUNT];
+   // per attribute, range of slots that may be dirty (empty if begin >= end)
+   unsigned _dirty_begin[ATTRIB_COUNT];
+   unsigned _dirty_end[ATTRIB_COUNT];
+   // counters of the last update
+   GLEnvStats _stats;
+   // packed values of the range being written (with GLE_PACKED)
+   std::vector<char> _staging;
 
    /* environment system variables */
-   // Offsets to distribute to Quads, and Quads
-   IntGenerator _quad_offsets;
-   std::vector<Quad> _quads;
+   // Offsets to distribute to Quads (in contiguous ranges for genQuads()), and Quads (in a deque so that growing it 
+   // keeps Quad pointers valid)
+   RangeGenerator _quad_offsets;
+   std::deque<Quad> _quads;
 
-   // maximum number of active Quads allowed
-   unsigned _max_count;
+   // number of slots allocated, initial number of slots, and number of active Quads (occupied slots)
+   unsigned _capacity;
+   unsigned _min_capacity;
    unsigned _count;
 
+   // number of consecutive update() calls with low usage
+   unsigned _low_updates;
+
+   // GLEnvFlag values provided on initialization
+   unsigned _flags;
+
    // flag to prevent moved GLEnv instances from doing anything
    bool _initialized;
+
+   // reallocates instance buffers and slot indexed arrays to the provided number of slots, preserving the active ones
+   void _resize(unsigned capacity);
+
+   // returns whether the program of a stage reads an attribute
+   bool _usesAttrib(unsigned stage, unsigned attrib);
+
+   // returns whether an attribute is stored in graphic memory with the flags provided on initialization
+   bool _hasAttrib(unsigned attrib);
+
+   // returns the number of stages in use, and the stage drawing a draw type
+   unsigned _stageCount();
+   unsigned _stageOf(unsigned type);
+
+   // returns the key of the bucket the values at a slot belong in
+   BucketKey _bucketKey(unsigned slot);
+
+   // returns the index of the bucket holding a slot
+   unsigned _bucketOf(unsigned slot);
+
+   // returns the slot after the last one of a bucket
+   unsigned _bucketEnd(unsigned bucket);
+
+   // returns whether the slot begins a range, i.e. whether it and the slot before it hold Quads of different ranges
+   bool _rangeBoundary(unsigned slot);
+
+   // frees a number of contiguous slots at the end of the bucket with the provided key (adding the bucket if needed) by
+   // moving the first slots of each following bucket to its end, or shifting the whole bucket if that would split a
+   // range, and returns the first; the slots' values and offsets are left to the caller
+   unsigned _insertSlots(BucketKey key, unsigned count);
+
+   // fills a number of contiguous slots of one bucket with the last slots of the bucket, then moves the hole along by 
+   // filling it with the last slots of each following bucket (removing the bucket if emptied); where taking the last
+   // slots would split a range, the slots after the hole are shifted down in order instead
+   void _eraseSlots(unsigned slot, unsigned count);
+
+   // moves the Quad with the provided offset into the bucket its values belong in, if different (with GLE_LAYERED)
+   void _rebucket(unsigned offset);
+
+   // binds the region written by the last update as the source of a stage's attributes (with GLE_PERSISTENT)
+   void _bindRegion(unsigned stage);
+
+   // draws every bucket with the layered program and a single indirect multi draw call (with GLE_LAYERED)
+   void _drawLayered();
+
+   // moves the values and offset of slot src into slot dst, or of a number of slots starting at src, in order, into 
+   // those starting at dst (the ranges may overlap)
+   void _moveSlot(unsigned dst, unsigned src);
+   void _moveSlots(unsigned dst, unsigned src, unsigned count);
+
+   // marks an attribute at the slot to be written by the following update() calls
+   void _setDirty(unsigned attrib, unsigned slot);
+
+   // returns the start of an attribute's shadow array
+   const char *_attribData(unsigned attrib);
+
+   // returns the number of bytes an attribute takes per slot in graphic memory
+   unsigned _attribSize(unsigned attrib);
+
+   // writes the values of an attribute in the range of slots [begin, end) into its buffer, packing them if needed
+   void _writeRange(unsigned attrib, unsigned begin, unsigned end);
+
+   // writes the dirty values of an attribute's shadow array into its buffer, coalescing them into ranges
+   void _uploadDirty(unsigned attrib);
+
+   // copies image data into the unpack buffer, and writes it into texture space from there
+   void _uploadTexture(const Image &img, GLuint xoffset, GLuint yoffset, GLuint zoffset);
 public:
    /* Calls init() with the provided arguments. */
-   GLEnv(unsigned max_count);
+   GLEnv(unsigned capacity, unsigned flags);
    GLEnv(GLEnv &&other);
    GLEnv();
    GLEnv(const GLEnv &Other) = delete;
@@ -126,12 +362,15 @@ public:
    GLEnv& operator=(GLEnv &&other);
    GLEnv& operator=(const GLEnv&) = delete;
 
-   /* Initializes GLBuffers, GLStage, and GLTexture2DArray, allowing the provided maximum amount of Quads. */
-   void init(unsigned max_count);
+   /* Initializes GLBuffers, GLStage, and GLTexture2DArray, with space for the provided amount of Quads.
+      capacity - initial amount of Quads to allocate space for (grown as needed, and never shrunk below)
+      flags - bitwise OR of GLEnvFlag values (GLE_NONE for default behavior)
+   */
+   void init(unsigned capacity, unsigned flags);
    void uninit();
 
    /* Generates an active Quad in system. This call does not write the new Quad into graphic memory. You 
-      must call the update() method on the environment or a reference to the Quad itself.
+      must call the update() method on the environment.
       pos - GLM vec3 position of Quad
       scale - GLM vec3 scale of Quad
       color - GLM vec4 color of Quad
@@ -140,32 +379,56 @@ public:
       type - whether to interpret this Quad data as a rectangle or ellipse
       Returns the integer offset of Quad. This number can be used to index into the internal Quad container and
       obtain a reference (see the get() method). This offset is unique and will be valid for the lifetime 
-      of the Quad (see the erase() method). If the maximum number of active Quads allowed is exceeded, -1 is
-      returned instead.
+      of the Quad (see the erase() method). If the capacity is exhausted, it is doubled first.
    */
    unsigned genQuad(glm::vec3 pos, glm::vec3 scale, glm::vec4 color, glm::vec3 texpos, glm::vec2 texsize, DrawType type);
+   /* Generates a number of active Quads with the same parameters as genQuad(), for objects made of several Quads 
+      (e.g. Text, particle bursts or tilemap rows). Their offsets form a contiguous range, and so do their slots, in 
+      the same order, so that writing every Quad of the range is uploaded as a single span. Slots are only moved
+      around whole ranges, so they stay contiguous until one of them is removed alone (or, with GLE_LAYERED, moved to
+      another layer); this may shift the rest of a bucket when removing or generating Quads next to a range.
+      count - number of Quads to generate (at least 1)
+      Returns the offset of the first Quad; the others follow it. The offsets can be removed individually by remove(),
+      or together by removeQuads().
+   */
+   unsigned genQuads(unsigned count, glm::vec3 pos, glm::vec3 scale, glm::vec4 color, glm::vec3 texpos, glm::vec2 texsize, DrawType type);
    /* Removes the Quad with the provided offset from the system. This will cause the provided offset to be 
       invalid until returned again by the genQuad() method. Note that this method does not actually
-      free any GPU memory; it simply makes the specific offset usable again by the system. Attempting to use
+      free any GPU memory; it simply makes the specific offset usable again by the system, and moves the 
+      values of other slots into the removed Quad's slot to keep active Quads packed. Attempting to use
       the same offset after erasing it and before receiving it again by genQuad() will result in undefined 
       behavior.
       offset - offset of Quad to remove
    */
    void remove(unsigned offset);
+   /* Removes a number of Quads with contiguous offsets, as returned by genQuads(), freeing their slots at once if they
+      are still contiguous.
+      first - offset of the first Quad to remove
+      count - number of Quads to remove
+   */
+   void removeQuads(unsigned first, unsigned count);
 
-   /* Initializes texture array space with unsigned byte storage in RGBA format.
+   /* Initializes texture array space with unsigned byte storage in RGBA format, and empties its atlas.
       width - width of space
       height - height of space
       depth - depth of space
    */
    void setTexArray(GLuint width, GLuint height, GLuint depth);
-   /* Loads image into texture space using Image structure (uses complete width and height of passed image).
+   /* Loads image into texture space using Image structure (uses complete width and height of passed image). The
+      layer written into is excluded from packing by packTexture(). Image data is copied into a persistently mapped 
+      pixel unpack buffer, from which OpenGL writes it into texture space asynchronously; this only blocks when the 
+      buffer wraps around before earlier uploads from it are done.
       img - Image structure containing RGBA unsigned byte image data
       x_offset - x offset in image space to write image data into
       y_offset - y offset in image space to write image data into
       z_offset - z offset in image space to write image data into
    */
-   void setTexture(Image img, GLuint x_offset, GLuint y_offset, GLuint z_offset);
+   void setTexture(const Image &img, GLuint x_offset, GLuint y_offset, GLuint z_offset);
+   /* Loads image into texture space at a position chosen by the texture space's Atlas, and returns the region 
+      written, to use as (or to offset) Frame and Quad texture values. Throws if no layer has enough free space.
+      img - Image structure containing RGBA unsigned byte image data
+   */
+   AtlasRegion packTexture(const Image &img);
    /* Sets view matrix for vertex shader.
       view - GLM mat4 matrix
    */
@@ -174,16 +437,33 @@ public:
       proj - GLM mat4 matrix
    */
    void setProj(glm::mat4 proj);
-   /* Stores the provided width and height as window space, for use in the fragment shader. */
+   /* Stores the provided width and height as window space, for use in the fragment shader (or as the size to
+      upscale to with GLE_OFFSCREEN). */
    void setWindowSpace(GLuint width, GLuint height);
-   /* Stores the provided width and height as pixel space, for use in the fragment shader. */
+   /* Stores the provided width and height as pixel space, for use in the fragment shader (or as the size of the
+      offscreen framebuffer with GLE_OFFSCREEN, which must be set before drawing). */
    void setPixelSpace(GLuint width, GLuint height, GLuint depth);
+   /* Writes the frames of all cycles of the provided Animations into shader storage, replacing previously written
+      ones (requires GLE_GPU_ANIM). Quads can only be set to Animations of the map, which must outlive their use; 
+      Quads set to previously written Animations must be set again.
+      animations - map of Animations (e.g. as returned by loadAnimations())
+   */
+   void setAnimations(std::unordered_map<std::string, Animation> &animations);
+   /* Advances the tick animated Quads are drawn at by one step (does nothing without GLE_GPU_ANIM). Should be 
+      called once per frame, in place of stepping each Quad's Animation. */
+   void stepAnims();
 
-   /* Writes data of all quads in system to their respective buffers. */
+   /* Writes data of quads in system that changed since they were last written to their respective buffers.
+      Changed values are gathered into contiguous ranges per buffer, merging ranges separated by no more than
+      GLENV_COALESCE_GAP unchanged values. With GLE_PERSISTENT, this first advances to the next region of the 
+      mapped buffers, waiting until the GPU has finished reading from it; changed values are then written 
+      into each region in turn. With GLE_SHRINK, this may shrink the capacity beforehand. */
    void update();
-   /* Draws Quads in memory using internal shader program. This is done by drawing a number of unit Quad
-      instances corresponding to the number of offsets generated, and using the specific Quad parameters and
-      shader matrices to transform them. */
+   /* Draws Quads in memory using internal shader programs. This is done by drawing, for each draw type, a number 
+      of unit Quad instances corresponding to the number of active Quads of the type, and using the specific Quad parameters and
+      shader matrices to transform them. With GLE_LAYERED, the instances of every bucket are instead drawn by a single 
+      indirect multi draw call, with blending enabled. With GLE_PERSISTENT, this draws from the region written by the 
+      last update() and places a fence for it. */
    void drawQuads();
 
    /* Returns a raw Quad pointer to the Quad with the specified offset. */
@@ -192,8 +472,14 @@ public:
    std::vector<unsigned> getOffsets();
    /* Returns true if the provided offset is active. */
    bool hasOffset(unsigned offset);
+   /* Returns the texture array Quads are textured from (e.g. to texture other geometry from the same space). */
+   GLUtil::GLTexture2DArray &getTexArray();
+   /* Returns the number of Quads space is currently allocated for. */
+   unsigned getCapacity();
    /* Returns whether this instance has been initialized or not. */
    bool getInitialized();
+   /* Returns the upload counters of the last update() call. */
+   GLEnvStats getStats();
 };
 
 #endif
\ No newline at end of file
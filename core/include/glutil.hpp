@@ -8,6 +8,13 @@
 #include <glm\gtc\type_ptr.hpp>
 #include <memory>
 #include <iostream>
+#include <fstream>
+#include <filesystem>
+#include <cstring>
+#include <cstdio>
+#include <string>
+#include <vector>
+#include <unordered_map>
 
 #include "commonexcept.hpp"
 
@@ -28,6 +35,104 @@ namespace GLUtil {
         GLErrorException();
     };
 
+    /* class GLBudgetException
+       This exception is thrown when more commands of a type were recorded than a budget allows (see 
+       GLCommandLog::budget()).
+    */
+    class GLBudgetException : public std::runtime_error {
+    public:
+        GLBudgetException(const std::string &msg);
+    };
+
+    /* enum GLBackend
+       Where the GLUtil classes and functions send their commands (see setBackend()).
+       - GLU_OPENGL - to the OpenGL driver only (default)
+       - GLU_LOGGED - to the OpenGL driver, and to the command log
+       - GLU_NULL - to the command log only, without touching a driver; no OpenGL context is needed
+    */
+    enum GLBackend { GLU_OPENGL, GLU_LOGGED, GLU_NULL };
+
+    /* enum GLCommandType
+       Categories of commands recorded in the command log.
+       - GLC_CREATE, GLC_DELETE - creation and deletion of objects (buffers, programs, textures, etc.)
+       - GLC_UPLOAD - data uploaded through the driver (buffer sub data, texture sub images)
+       - GLC_WRITE - data written straight into persistently mapped memory, without a command
+       - GLC_COPY - copies between buffers or framebuffers on the GPU
+       - GLC_BIND - bindings of buffers, textures, framebuffers and programs
+       - GLC_UNIFORM - uniform sets
+       - GLC_STATE - other state changes (attribute formats, texture parameters, viewport, clears)
+       - GLC_SYNC - fence placements
+       - GLC_DRAW - draw calls
+    */
+    enum GLCommandType { 
+        GLC_CREATE, GLC_DELETE, GLC_UPLOAD, GLC_WRITE, GLC_COPY, GLC_BIND, GLC_UNIFORM, GLC_STATE, GLC_SYNC, GLC_DRAW, 
+        GLC_TYPES 
+    };
+
+    /* struct GLCommand
+       A recorded command.
+       - type - category of the command
+       - handle - object the command applies to, if any (0 otherwise)
+       - bytes - bytes of data the command transfers, if any (0 otherwise)
+       - count - number of instances drawn by draw calls, or number of draws of indirect multi draw calls (0 otherwise)
+    */
+    struct GLCommand {
+        GLCommandType type;
+        GLuint handle;
+        GLsizeiptr bytes;
+        GLuint count;
+        // default copy assignment/construction are fine
+    };
+
+    /* class GLCommandLog
+       In-memory log of the commands issued through GLUtil while the backend is GLU_LOGGED or GLU_NULL (see 
+       commandLog()). Counts the commands and bytes of each type, and optionally keeps every command in order. 
+       Meant to be cleared once per frame, to measure or limit per-frame submission (e.g. at most N uploads).
+    */
+    class GLCommandLog {
+        std::vector<GLCommand> _commands;
+        unsigned _counts[GLC_TYPES];
+        GLsizeiptr _bytes[GLC_TYPES];
+        bool _keep;
+
+    public:
+        GLCommandLog();
+        // default copy assignment/construction are fine
+
+        /* Counts a command, and keeps it if keeping commands. */
+        void record(GLCommandType type, GLuint handle, GLsizeiptr bytes, GLuint count);
+
+        /* Resets all counts and removes kept commands. */
+        void clear();
+
+        /* Sets whether every command is kept in addition to being counted (false by default). */
+        void setKeepCommands(bool keep);
+
+        /* Returns the number of commands of the type recorded since the last clear(). */
+        unsigned count(GLCommandType type);
+        /* Returns the bytes transferred by commands of the type since the last clear(). */
+        GLsizeiptr bytes(GLCommandType type);
+        /* Returns the commands kept since the last clear(), in order. */
+        const std::vector<GLCommand> &commands();
+
+        /* Throws GLBudgetException if more than max commands of the type were recorded since the last clear(). */
+        void budget(GLCommandType type, unsigned max);
+
+        /* Writes the count and bytes of each command type to the stream. */
+        void print(std::ostream &out);
+    };
+
+    /* struct GLStateStats
+       Counts of the binding, uniform and viewport calls made through GLUtil since the last clearStateStats().
+       - issued - calls that changed state, and were sent to the backend
+       - skipped - calls skipped as redundant, since the state cache already held their value
+    */
+    struct GLStateStats {
+        unsigned issued = 0;
+        unsigned skipped = 0;
+        // default copy assignment/construction are fine
+    };
+
     /* class GLStage
        Represents an execution stage of OpenGL; stores a program handle and VAO.
 
@@ -38,6 +143,18 @@ namespace GLUtil {
         GLint _program_h;
         GLint _vao_h;
 
+        // last value set for each uniform location and vertex buffer binding index (empty if never set), to skip
+        // redundant calls
+        std::vector<std::vector<char>> _uniforms;
+        std::vector<std::vector<char>> _vertex_buffers;
+
+        // creates the program from the binary stored at the path, returning false if it is missing or rejected
+        bool _loadBinary(const std::string &path);
+        // stores the binary of the linked program at the path
+        void _saveBinary(const std::string &path);
+        // compiles and links the program from the shader sources
+        void _compile(const char *shader_srcs[], GLenum shader_types[], int count);
+
     public:
         /* Calls init() with the provided arguments. */
         GLStage(const char *shader_srcs[], GLenum shader_types[], int count);
@@ -49,7 +166,9 @@ namespace GLUtil {
         GLStage& operator=(GLStage &&other);
         GLStage& operator=(const GLStage&) = delete;
 
-        /* Creates a program with the provided shader sources.
+        /* Creates a program with the provided shader sources. If a program cache directory is set (see 
+           setProgramCacheDir()), a program binary previously stored for the same sources and driver is loaded 
+           instead, and newly linked programs are stored there.
         */
         void init(const char *shader_srcs[], GLenum shader_types[], int count);
         void uninit();
@@ -62,6 +181,12 @@ namespace GLUtil {
            divisor - number of instances to process before changing value (0 for per vertex, 1 for per instance, etc.)
         */
         void setAttribFormat(GLuint index, GLint size, GLenum type, GLuint byte_offset, GLuint divisor);
+        /* Same as above, but with integer types optionally normalized to [0, 1] (unsigned) or [-1, 1] (signed) 
+           instead of converted directly to floating point values.
+        */
+        void setAttribFormat(GLuint index, GLint size, GLenum type, bool normalized, GLuint byte_offset, GLuint divisor);
+        /* Same as above, but for integer attributes (e.g. uvec4), whose values are not converted to floating point. */
+        void setAttribIFormat(GLuint index, GLint size, GLenum type, GLuint byte_offset, GLuint divisor);
         
         /* Binds attribute to the specified buffer index. */
         void setAttribBufferIndex(GLuint attrib_index, GLuint binding_index);
@@ -75,6 +200,7 @@ namespace GLUtil {
         /* Sets uniform value in program. */
         void uniform1i(GLuint index, GLint value);
         void uniform1f(GLuint index, GLfloat value);
+        void uniform1ui(GLuint index, GLuint value);
         void uniformmat4f(GLuint index, glm::mat4 value);
         void uniform2ui(GLuint index, glm::uvec2 value);
         void uniform3ui(GLuint index, glm::uvec3 value);
@@ -85,14 +211,25 @@ namespace GLUtil {
 
     /* class GLBuffer
        Preserves the state of a single OpenGL buffer with a fixed usage and byte size.
+       The buffer can alternatively be created with immutable storage (see initStorage()), 
+       in which case it can be persistently mapped; while mapped, subData() writes directly 
+       into the mapped memory instead of making an OpenGL call.
     
        It is undefined behavior to make method calls (except for uninit()) on instances 
-       of this class without calling init() first.
+       of this class without calling init() or initStorage() first.
     */
     class GLBuffer {
         GLint _buf_h;
         GLenum _usage;
         GLuint _size;
+        GLbitfield _storage_flags;
+
+        // persistently mapped memory, and base offset applied to subData() writes into it
+        char *_mapped;
+        GLuint _map_offset;
+
+        // contents of the buffer under the null backend, standing in for driver memory
+        char *_host;
 
     public:
         /* Calls init() with the provided arguments. */
@@ -108,8 +245,22 @@ namespace GLUtil {
         /* Creates buffer with provided size.
         */
         void init(GLenum buffer_usage, GLuint buffer_size);
+        /* Creates buffer with provided size and immutable storage, using the provided storage flags
+           (e.g. GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT).
+        */
+        void initStorage(GLbitfield storage_flags, GLuint buffer_size);
         void uninit();
 
+        /* Persistently maps the complete buffer for writing; the buffer must have been created with
+           initStorage() using the write, persistent and coherent storage flags. Returns the mapped memory.
+        */
+        void *mapPersistent();
+
+        /* Sets the byte offset added to the offsets passed to subData() while the buffer is mapped. Used 
+           to select a region of a persistently mapped buffer to write into.
+        */
+        void setMapOffset(GLuint offset);
+
         /* Binds buffer handle of GLBuffer to target.
         */
         void bind(GLenum target);
@@ -118,17 +269,98 @@ namespace GLUtil {
         */
         void bindBase(GLenum target, GLuint index);
 
-        /* Updates sub data in GLBuffer; size and offset in bytes (e.g. 16 for 4 4-byte vertices).
+        /* Updates sub data in GLBuffer; size and offset in bytes (e.g. 16 for 4 4-byte vertices). If the buffer
+           is persistently mapped, the data is copied into the mapped memory at the offset plus the map offset.
         */
         void subData(GLsizeiptr data_size, const void *data, GLsizeiptr offset);
 
+        /* Copies data from another GLBuffer into this one on the GPU, without reading it back; size and offsets
+           in bytes. This bypasses the map offset.
+        */
+        void copySubData(GLBuffer &src, GLsizeiptr data_size, GLsizeiptr src_offset, GLsizeiptr offset);
+
         GLuint size();
         GLenum usage();
         GLuint handle();
+        bool mapped();
 
         const char *copy_mem();
     };
 
+    /* class GLFence
+       Wraps an OpenGL fence sync object, used to wait on the completion of commands issued before it
+       was placed.
+    */
+    class GLFence {
+        GLsync _sync;
+
+    public:
+        GLFence();
+        GLFence(GLFence &&other);
+        GLFence(const GLFence&) = delete;
+        ~GLFence();
+
+        GLFence& operator=(GLFence &&other);
+        GLFence& operator=(const GLFence&) = delete;
+
+        /* Places a new fence into the command stream, replacing any previously placed fence. */
+        void place();
+
+        /* Blocks until all commands issued before the placed fence have completed. Does nothing if no
+           fence has been placed, and removes the fence once it has been waited on.
+        */
+        void wait();
+
+        void uninit();
+    };
+
+    /* class GLFramebuffer
+       Preserves the state of an OpenGL framebuffer with an RGBA8 color texture and a 24-bit depth renderbuffer
+       of a fixed size, to render offscreen.
+
+       It is undefined behavior to make method calls (except for uninit()) on instances 
+       of this class without calling init() first.
+    */
+    class GLFramebuffer {
+        GLint _fbo_h;
+        GLuint _color_h;
+        GLuint _depth_h;
+        GLuint _width;
+        GLuint _height;
+
+    public:
+        /* Calls init() with the provided arguments. */
+        GLFramebuffer(GLuint width, GLuint height);
+        GLFramebuffer(GLFramebuffer &&other);
+        GLFramebuffer();
+        GLFramebuffer(const GLFramebuffer&) = delete;
+        ~GLFramebuffer();
+
+        GLFramebuffer& operator=(GLFramebuffer &&other);
+        GLFramebuffer& operator=(const GLFramebuffer&) = delete;
+
+        /* Creates the framebuffer and its attachments with the provided size. Throws if the framebuffer is 
+           incomplete.
+        */
+        void init(GLuint width, GLuint height);
+        void uninit();
+
+        /* Binds the framebuffer for drawing, and sets the viewport to its size. */
+        void bind();
+
+        /* Clears the color (to the current clear color) and depth of the framebuffer; it must be bound. */
+        void clear();
+
+        /* Copies the color attachment into the default framebuffer (see setDefaultFramebuffer()), stretched to the 
+           provided size with nearest filtering.
+        */
+        void blitToDefault(GLuint width, GLuint height);
+
+        GLuint width();
+        GLuint height();
+        GLuint handle();
+    };
+
     /* class GLTexture2DArray
        Preserves the state of a single mutable OpenGL 2D texture array.
 
@@ -280,6 +512,43 @@ namespace GLUtil {
     */
     void renderInst(GLenum mode, GLsizei count, GLuint num_inst, bool with_elements);
 
+    /* Renders provided number of elements in the specified mode, as numinst instances, with per instance attributes
+       starting at instance base_inst.
+    */
+    void renderInstBase(GLenum mode, GLsizei count, GLuint num_inst, GLuint base_inst, bool with_elements);
+
+    /* struct GLDrawCommand
+       Parameters of one draw of an indirect multi draw, as read from the buffer bound to GL_DRAW_INDIRECT_BUFFER
+       (see renderMultiIndirect()).
+       - count - number of elements to render
+       - instance_count - number of instances to render
+       - first_index - first element to render
+       - base_vertex - value added to element indices
+       - base_instance - instance that per instance attributes start at
+    */
+    struct GLDrawCommand {
+        GLuint count;
+        GLuint instance_count;
+        GLuint first_index;
+        GLint base_vertex;
+        GLuint base_instance;
+        // default copy assignment/construction are fine
+    };
+
+    /* Renders draw_count draws of elements in the specified mode with a single call, reading the parameters of each 
+       from consecutive GLDrawCommand structures at the start of the buffer bound to GL_DRAW_INDIRECT_BUFFER.
+    */
+    void renderMultiIndirect(GLenum mode, GLsizei draw_count);
+
+    /* Enables or disables blending of fragment colors into the framebuffer by their alpha (source alpha, one minus
+       source alpha).
+    */
+    void setBlending(bool enabled);
+
+    /* Clears the buffers in the mask (e.g. GL_COLOR_BUFFER_BIT) of the bound framebuffer.
+    */
+    void clear(GLbitfield mask);
+
     /* Sets OpenGL viewport.
        x - x coordinate of viewport
        y - y coordinate of viewport
@@ -288,7 +557,52 @@ namespace GLUtil {
     */
     void setViewport(GLint x, GLint y, GLint width, GLint height);
 
-    /* Initializes OpenGL. */
+    /* Binds the default framebuffer for drawing.
+    */
+    void bindDefaultFramebuffer();
+
+    /* Sets the framebuffer used in place of the window's framebuffer by bindDefaultFramebuffer() and 
+       GLFramebuffer::blitToDefault() (e.g. an offscreen target when running without a window); 0 (default) for the 
+       window's framebuffer.
+    */
+    void setDefaultFramebuffer(GLuint handle);
+
+    /* Unbinds any buffer from the target (e.g. GL_PIXEL_UNPACK_BUFFER, so that texture data is read from client
+       memory again).
+    */
+    void unbindBuffer(GLenum target);
+
+    /* Sets the directory GLStage program binaries are cached in, creating it if needed; an empty string (default)
+       disables caching. Binaries are keyed by a hash of the shader sources and types, and of the OpenGL vendor,
+       renderer and version strings.
+    */
+    void setProgramCacheDir(const char *dir);
+
+    /* Sets the backend commands are sent to (GLU_OPENGL by default). Must be set before any GLUtil object is 
+       initialized, as objects created under the null backend have no OpenGL counterpart. Program binaries are not
+       cached under the null backend.
+    */
+    void setBackend(GLBackend backend);
+    GLBackend getBackend();
+
+    /* Returns the log commands are recorded into under the GLU_LOGGED and GLU_NULL backends. */
+    GLCommandLog &commandLog();
+
+    /* Returns the counts of issued and skipped state changing calls. State changing calls (GLStage::use(), uniform 
+       sets, vertex buffer bindings, GLBuffer and GLTexture2DArray binds, framebuffer binds, viewport and blending 
+       changes) are checked against a cache of the context's state, and skipped if they would not change it, so that several
+       GLEnvs can share a context cheaply.
+    */
+    GLStateStats getStateStats();
+    void clearStateStats();
+
+    /* Forgets the cached state of the context, so that the next state changing calls are all issued. Must be 
+       called after changing bindings or the viewport with OpenGL calls made outside of GLUtil, or making another 
+       context current. Called by glinit().
+    */
+    void resetStateCache();
+
+    /* Initializes OpenGL; does nothing under the null backend. */
     void glinit(bool debug);
 };
 
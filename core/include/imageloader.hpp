@@ -0,0 +1,84 @@
+#ifndef IMAGELOADER_HPP_
+#define IMAGELOADER_HPP_
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <exception>
+#include <functional>
+#include <string>
+#include <thread>
+#include <vector>
+#include "util.hpp"
+#include "commonexcept.hpp"
+
+/* struct ImageTiming
+   Time spent loading an Image, in milliseconds.
+   - decode - decoding the file into an Image (on a worker thread)
+   - upload - passing the Image to the upload callback (on the thread calling ImageLoader::upload())
+*/
+struct ImageTiming {
+    double decode = 0.0;
+    double upload = 0.0;
+    // default copy assignment/construction are fine
+};
+
+/* class ImageLoader
+   Decodes a batch of image files into Images on a pool of worker threads, so that decoding can overlap with
+   other startup work (e.g. creating the OpenGL context), and then hands the Images to the thread owning the
+   OpenGL context for uploading. Records the decoding and uploading time of each Image.
+
+   Decoding is started by start(), and waited on by wait() or upload(). It is undefined behavior to access the
+   Images while decoding has not been waited on.
+*/
+class ImageLoader {
+    std::vector<std::string> _filenames;
+    std::vector<Image> _images;
+    std::vector<ImageTiming> _timings;
+    // error of each file that failed to decode
+    std::vector<std::exception_ptr> _errors;
+    // time decoding started, and time each file finished decoding
+    std::chrono::steady_clock::time_point _start;
+    std::vector<std::chrono::steady_clock::time_point> _decoded;
+
+    std::vector<std::thread> _workers;
+    // index of the next file to decode, shared by the workers
+    std::atomic<unsigned> _next;
+
+    // decodes files until none are left
+    void _work();
+
+public:
+    ImageLoader();
+    ImageLoader(const ImageLoader&) = delete;
+    ~ImageLoader();
+
+    ImageLoader& operator=(const ImageLoader&) = delete;
+
+    /* Starts decoding the files, replacing any previously loaded Images. Throws if decoding is already in progress.
+       filenames - image files to decode, in order of their indices
+       threads - number of worker threads to decode with (0 for the number of hardware threads)
+    */
+    void start(const std::vector<std::string> &filenames, unsigned threads);
+
+    /* Blocks until every file is decoded. Rethrows the error of the first file that failed to decode. */
+    void wait();
+
+    /* Waits for decoding, then calls upload with the index of each Image and the Image, in order, on the calling
+       thread, timing each call. Each Image is freed once uploaded.
+    */
+    void upload(const std::function<void(unsigned, const Image&)> &upload);
+
+    /* Returns the decoded Image with the provided index. */
+    Image &image(unsigned i);
+    /* Returns the timings of the Image with the provided index. */
+    const ImageTiming &timing(unsigned i);
+    /* Returns the number of files in the batch. */
+    unsigned count();
+    /* Returns the wall clock time from start() until the last file was decoded, in milliseconds. */
+    double decodeWallTime();
+    /* Writes the timings of each file, their totals, and the wall clock time of decoding, to the stream. */
+    void printTimings(std::ostream &out);
+};
+
+#endif
@@ -0,0 +1,669 @@
+#ifndef LAYOUTENV_HPP_
+#define LAYOUTENV_HPP_
+
+#include <string_view>
+#include <initializer_list>
+
+#include "glenv.hpp"
+
+/* Per instance attributes that can be part of a LayoutEnv's instance layout, combined with bitwise OR. */
+enum LayoutAttrib { GLL_POS = 0x1, GLL_SCALE = 0x2, GLL_COLOR = 0x4, GLL_TEXPOS = 0x8, GLL_TEXSIZE = 0x10 };
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+/* namespace LayoutShaders
+   Shader source fragments of LayoutEnv instance layouts, composed at compile time.
+*/
+namespace LayoutShaders {
+   // maximum length of composed shader source, including terminator
+   constexpr unsigned SOURCE_CAPACITY = 4096;
+
+   /* struct Source
+      Fixed capacity, null terminated shader source.
+   */
+   struct Source {
+      char data[SOURCE_CAPACITY];
+      unsigned size;
+   };
+
+   /* Concatenates the provided parts into a Source. Exceeding the capacity fails compilation when used in a
+      constant expression. */
+   constexpr Source compose(std::initializer_list<std::string_view> parts) {
+      Source src{};
+      unsigned n = 0;
+      for (std::string_view part : parts)
+         for (char c : part)
+            src.data[n++] = c;
+      src.data[n] = '\0';
+      src.size = n;
+      return src;
+   }
+
+   constexpr std::string_view none = "";
+
+   constexpr std::string_view version = "#version 450\n";
+
+   /* vertex shader */
+   constexpr std::string_view vert_inputs = R"(
+      layout(location = 0) in vec4 v_model;
+      layout(location = 1) in vec3 v_pos;
+      layout(location = 2) in vec3 v_scale;
+   )";
+   constexpr std::string_view vert_color_inputs = R"(
+      layout(location = 3) in vec4 v_color;
+      out vec4 f_color;
+   )";
+   constexpr std::string_view vert_tex_inputs = R"(
+      layout(location = 4) in vec3 v_texpos;
+      layout(location = 5) in vec2 v_texsize;
+      out vec3 f_texcoords;
+   )";
+   constexpr std::string_view vert_ellipse_outputs = R"(
+      out vec3 f_pos;
+      out vec3 f_scale;
+   )";
+   constexpr std::string_view vert_main_begin = R"(
+      layout(location = 8) uniform mat4 u_view;
+      layout(location = 9) uniform mat4 u_proj;
+
+      void main() {
+   )";
+   constexpr std::string_view vert_color_main = R"(
+         f_color = v_color;
+   )";
+   constexpr std::string_view vert_tex_main = R"(
+         // add texsize multiplied by model positions to texpos, flipping the vertical shift
+         f_texcoords = v_texpos + (vec3(v_texsize, 0.0) * vec3(v_model.x, 1.0 - v_model.y, 0.0));
+   )";
+   constexpr std::string_view vert_ellipse_main = R"(
+         f_pos = v_pos;
+         f_scale = v_scale;
+   )";
+   constexpr std::string_view vert_main_end = R"(
+         // shift unit model to center, scale it, and add position
+         vec4 final_pos = ((v_model + vec4(-0.5f, -0.5f, 0.0f, 0.0f)) * vec4(v_scale, 1.0f)) + vec4(v_pos, 0.0f);
+         gl_Position = u_proj * u_view * round(final_pos);
+      }
+   )";
+
+   /* fragment shader */
+   constexpr std::string_view frag_color_inputs = R"(
+      in vec4 f_color;
+   )";
+   constexpr std::string_view frag_tex_inputs = R"(
+      layout(location = 10) uniform sampler2DArray texsamplerarray;
+      layout(location = 11) uniform uvec3 texarraydims;
+      in vec3 f_texcoords;
+   )";
+   constexpr std::string_view frag_ellipse_inputs = R"(
+      layout(location = 12) uniform uvec2 windowspace;
+      layout(location = 13) uniform uvec3 pixelspace;
+      in vec3 f_pos;
+      in vec3 f_scale;
+
+      vec2 halfround(vec2 v) {
+         return floor(v) + vec2(0.5);
+      }
+   )";
+   constexpr std::string_view frag_main_begin = R"(
+      out vec4 fragcolor;
+
+      void main() {
+         vec4 color = vec4(1.0);
+   )";
+   constexpr std::string_view frag_color_main = R"(
+         color = f_color;
+   )";
+   constexpr std::string_view frag_tex_main = R"(
+         // normalize "raw" texture coordinates with full texture size
+         vec4 texel = texture(texsamplerarray, f_texcoords / vec3(texarraydims.xy, 1));
+         if (texel.xyz == vec3(255.0 / 255.0, 0.0, 128.0 / 255.0))
+            discard;
+         color *= texel;
+   )";
+   constexpr std::string_view frag_ellipse_main = R"(
+         // distance from quad center of fragment, in pixel space normalized to the quad
+         vec2 pixelspacef2D = vec2(pixelspace.xy);
+         vec2 local = (
+            halfround(gl_FragCoord.xy * (pixelspacef2D / vec2(windowspace)))
+            - ((f_pos.xy + (pixelspacef2D / 2.0)) - (f_scale.xy / 2.0))
+         ) / f_scale.xy;
+         if (distance(vec2(0.5), local) > 0.5)
+            discard;
+   )";
+   constexpr std::string_view frag_main_end = R"(
+         fragcolor = color;
+      }
+   )";
+}
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+/* class LayoutArray
+   A per instance attribute of a LayoutEnv: a shadow array of values indexed by slot, with dirty tracking, and the
+   buffer they are written into. Arrays that are never initialized hold no memory.
+*/
+template<class T>
+class LayoutArray {
+   GLUtil::GLBuffer _buffer;
+   std::vector<T> _values;
+
+   // whether each slot must be written, and range of slots that may be dirty (empty if begin >= end)
+   std::vector<bool> _dirty;
+   unsigned _dirty_begin;
+   unsigned _dirty_end;
+
+   // writes the values in the range of slots [begin, end)
+   void _write(unsigned begin, unsigned end, GLEnvStats &stats) {
+      _buffer.subData((end - begin) * sizeof(T), &_values[begin], begin * sizeof(T));
+      stats.upload_bytes += (end - begin) * sizeof(T);
+      stats.upload_ranges++;
+   }
+
+public:
+   LayoutArray() : _dirty_begin(0), _dirty_end(0) {}
+   LayoutArray(LayoutArray<T> &&other) { operator=(std::move(other)); }
+   LayoutArray(const LayoutArray<T> &other) = delete;
+   ~LayoutArray() { /* automatic destruction is fine */ }
+
+   LayoutArray<T> &operator=(LayoutArray<T> &&other) {
+      if (this != &other) {
+         _buffer = std::move(other._buffer);
+         _values = std::move(other._values);
+         _dirty = std::move(other._dirty);
+         _dirty_begin = other._dirty_begin;
+         _dirty_end = other._dirty_end;
+         other._dirty_begin = 0;
+         other._dirty_end = 0;
+      }
+      return *this;
+   }
+   LayoutArray<T> &operator=(const LayoutArray<T> &other) = delete;
+
+   /* Allocates the buffer and shadow array with space for the provided number of slots. */
+   void init(unsigned capacity) {
+      _buffer.init(GL_DYNAMIC_DRAW, capacity * sizeof(T));
+      _values = std::vector<T>(capacity, T(0.0f));
+      _dirty = std::vector<bool>(capacity, false);
+      _dirty_begin = 0;
+      _dirty_end = 0;
+   }
+   void uninit() {
+      _buffer.uninit();
+      _values.clear();
+      _dirty.clear();
+      _dirty_begin = 0;
+      _dirty_end = 0;
+   }
+
+   /* Reallocates the buffer and shadow array to the provided number of slots, copying the first count slots of the
+      buffer on the GPU. */
+   void resize(unsigned capacity, unsigned count) {
+      GLUtil::GLBuffer buffer(GL_DYNAMIC_DRAW, capacity * sizeof(T));
+      buffer.copySubData(_buffer, count * sizeof(T), 0, 0);
+      _buffer.uninit();
+      _buffer = std::move(buffer);
+
+      _values.resize(capacity, T(0.0f));
+      _dirty.resize(capacity, false);
+      _dirty_end = std::min(_dirty_end, capacity);
+   }
+
+   /* Marks the slot to be written by the next upload(). */
+   void mark(unsigned slot) {
+      _dirty[slot] = true;
+      if (_dirty_begin >= _dirty_end) {
+         _dirty_begin = slot;
+         _dirty_end = slot + 1;
+      } else {
+         _dirty_begin = std::min(_dirty_begin, slot);
+         _dirty_end = std::max(_dirty_end, slot + 1);
+      }
+   }
+
+   /* Sets the value of the slot, marking it if it changed. */
+   void set(unsigned slot, const T &value) {
+      if (_values[slot] == value)
+         return;
+      _values[slot] = value;
+      mark(slot);
+   }
+
+   const T &get(unsigned slot) { return _values[slot]; }
+
+   /* Moves the value of slot src into slot dst. */
+   void move(unsigned dst, unsigned src) {
+      _values[dst] = _values[src];
+      mark(dst);
+   }
+
+   /* Writes the dirty values of the first count slots into the buffer, merging ranges separated by no more than
+      GLENV_COALESCE_GAP clean values. */
+   void upload(unsigned count, GLEnvStats &stats) {
+      unsigned end = std::min(_dirty_end, count);
+      unsigned range_begin = 0;
+      unsigned range_end = 0;
+
+      for (unsigned i = _dirty_begin; i < end; i++) {
+         if (!_dirty[i])
+            continue;
+         _dirty[i] = false;
+
+         // extend current range if the gap to it is small enough, otherwise write it and start a new one
+         if (range_end > range_begin && i - range_end <= GLENV_COALESCE_GAP)
+            range_end = i + 1;
+         else {
+            if (range_end > range_begin)
+               _write(range_begin, range_end, stats);
+            range_begin = i;
+            range_end = i + 1;
+         }
+      }
+      if (range_end > range_begin)
+         _write(range_begin, range_end, stats);
+
+      _dirty_begin = 0;
+      _dirty_end = 0;
+   }
+
+   GLuint handle() { return _buffer.handle(); }
+
+   /* Binds the buffer to an indexed binding point of the target (e.g. to read the values as shader storage). */
+   void bindBase(GLenum target, GLuint index) { _buffer.bindBase(target, index); }
+};
+
+// --------------------------------------------------------------------------------------------------------------------------
+
+/* class LayoutEnv
+   A sibling of GLEnv whose instance layout and draw type are fixed at compile time. Only the attributes in ATTRIBS
+   (a bitwise OR of LayoutAttrib values) get a buffer, a shadow array, uploads and shader inputs; the vertex
+   and fragment shaders are composed at compile time from the layout, so that no unused attribute is read and the
+   fragment shader does not branch on the draw type.
+
+   - GLL_POS and GLL_SCALE are required.
+   - GLL_COLOR is optional; without it, Quads are untinted (white if untextured).
+   - GLL_TEXPOS and GLL_TEXSIZE must be used together, and only with GLE_RECT; without them, rectangles are flat.
+
+   Like GLEnv, active Quads are kept densely packed behind stable offsets, only changed values are written by update(),
+   and capacity doubles on demand with the buffers copied on the GPU. Persistent mapping, packed formats and shrinking
+   are not supported. Values are accessed through the environment by offset rather than through Quad views.
+
+   It is undefined behavior to make method calls (except for uninit()) on instances
+   of this class without calling init() first.
+*/
+template<unsigned ATTRIBS, DrawType TYPE>
+class LayoutEnv {
+   static constexpr bool _has_color = (ATTRIBS & GLL_COLOR) != 0;
+   static constexpr bool _has_tex = (ATTRIBS & GLL_TEXPOS) != 0;
+   static constexpr bool _is_ellipse = TYPE == GLE_ELLIPSE;
+
+   static_assert((ATTRIBS & GLL_POS) && (ATTRIBS & GLL_SCALE), "LayoutEnv requires GLL_POS and GLL_SCALE");
+   static_assert(((ATTRIBS & GLL_TEXPOS) != 0) == ((ATTRIBS & GLL_TEXSIZE) != 0), "LayoutEnv requires GLL_TEXPOS and GLL_TEXSIZE together");
+   static_assert(!(_is_ellipse && _has_tex), "LayoutEnv cannot texture GLE_ELLIPSE Quads");
+
+   // shader sources of this layout
+   static constexpr LayoutShaders::Source _vert_src = LayoutShaders::compose({
+      LayoutShaders::version,
+      LayoutShaders::vert_inputs,
+      _has_color ? LayoutShaders::vert_color_inputs : LayoutShaders::none,
+      _has_tex ? LayoutShaders::vert_tex_inputs : LayoutShaders::none,
+      _is_ellipse ? LayoutShaders::vert_ellipse_outputs : LayoutShaders::none,
+      LayoutShaders::vert_main_begin,
+      _has_color ? LayoutShaders::vert_color_main : LayoutShaders::none,
+      _has_tex ? LayoutShaders::vert_tex_main : LayoutShaders::none,
+      _is_ellipse ? LayoutShaders::vert_ellipse_main : LayoutShaders::none,
+      LayoutShaders::vert_main_end
+   });
+   static constexpr LayoutShaders::Source _frag_src = LayoutShaders::compose({
+      LayoutShaders::version,
+      _has_color ? LayoutShaders::frag_color_inputs : LayoutShaders::none,
+      _has_tex ? LayoutShaders::frag_tex_inputs : LayoutShaders::none,
+      _is_ellipse ? LayoutShaders::frag_ellipse_inputs : LayoutShaders::none,
+      LayoutShaders::frag_main_begin,
+      _has_color ? LayoutShaders::frag_color_main : LayoutShaders::none,
+      _has_tex ? LayoutShaders::frag_tex_main : LayoutShaders::none,
+      _is_ellipse ? LayoutShaders::frag_ellipse_main : LayoutShaders::none,
+      LayoutShaders::frag_main_end
+   });
+
+   /* environment structures */
+   GLUtil::GLStage _stage;
+   GLUtil::GLTexture2DArray _texarray;
+   GLUtil::GLBuffer _glb_modelbuf;
+   GLUtil::GLBuffer _glb_elembuf;
+
+   /* per instance attributes (only those in ATTRIBS are initialized) */
+   LayoutArray<glm::vec3> _pos;
+   LayoutArray<glm::vec3> _scale;
+   LayoutArray<glm::vec4> _color;
+   LayoutArray<glm::vec3> _texpos;
+   LayoutArray<glm::vec2> _texsize;
+
+   /* dense packing of active Quads */
+   // slot of each Quad offset (indexed by offset), and Quad offset held by each slot (indexed by slot)
+   std::vector<unsigned> _slots;
+   std::vector<unsigned> _slot_offsets;
+   IntGenerator _quad_offsets;
+
+   // number of slots allocated, and number of active Quads (occupied slots)
+   unsigned _capacity;
+   unsigned _count;
+
+   // counters of the last update
+   GLEnvStats _stats;
+
+   // flag to prevent moved LayoutEnv instances from doing anything
+   bool _initialized;
+
+   // binds the buffers of the layout's attributes to their buffer indices
+   void _bindAttribs() {
+      _stage.bindBufferToIndex(_pos.handle(), 1, 0, sizeof(glm::vec3));
+      _stage.bindBufferToIndex(_scale.handle(), 2, 0, sizeof(glm::vec3));
+      if constexpr (_has_color)
+         _stage.bindBufferToIndex(_color.handle(), 3, 0, sizeof(glm::vec4));
+      if constexpr (_has_tex) {
+         _stage.bindBufferToIndex(_texpos.handle(), 4, 0, sizeof(glm::vec3));
+         _stage.bindBufferToIndex(_texsize.handle(), 5, 0, sizeof(glm::vec2));
+      }
+   }
+
+   // doubles the capacity, copying active slots on the GPU
+   void _grow() {
+      unsigned capacity = std::max(_capacity * 2, 1u);
+      _pos.resize(capacity, _count);
+      _scale.resize(capacity, _count);
+      if constexpr (_has_color)
+         _color.resize(capacity, _count);
+      if constexpr (_has_tex) {
+         _texpos.resize(capacity, _count);
+         _texsize.resize(capacity, _count);
+      }
+      _slot_offsets.resize(capacity, 0);
+      _capacity = capacity;
+      _bindAttribs();
+   }
+
+   // returns the slot of an active offset
+   unsigned _slot(unsigned offset) {
+      if (offset >= _quad_offsets.size())
+         throw std::out_of_range("Index out of range");
+      if (!_quad_offsets.at(offset))
+         throw InactiveIntException();
+      return _slots[offset];
+   }
+
+public:
+   /* Calls init() with the provided arguments. */
+   LayoutEnv(unsigned capacity) : _capacity(0), _count(0), _initialized(false) { init(capacity); }
+   LayoutEnv(LayoutEnv &&other) { operator=(std::move(other)); }
+   LayoutEnv() : _capacity(0), _count(0), _initialized(false) {}
+   LayoutEnv(const LayoutEnv &other) = delete;
+   ~LayoutEnv() { uninit(); }
+
+   LayoutEnv &operator=(LayoutEnv &&other) {
+      if (this != &other) {
+         _stage = std::move(other._stage);
+         _texarray = std::move(other._texarray);
+         _glb_modelbuf = std::move(other._glb_modelbuf);
+         _glb_elembuf = std::move(other._glb_elembuf);
+         _pos = std::move(other._pos);
+         _scale = std::move(other._scale);
+         _color = std::move(other._color);
+         _texpos = std::move(other._texpos);
+         _texsize = std::move(other._texsize);
+         _slots = std::move(other._slots);
+         _slot_offsets = std::move(other._slot_offsets);
+         _quad_offsets = other._quad_offsets;
+         _capacity = other._capacity;
+         _count = other._count;
+         _stats = other._stats;
+         _initialized = other._initialized;
+         other._quad_offsets.clear();
+         other._capacity = 0;
+         other._count = 0;
+         other._initialized = false;
+      }
+      return *this;
+   }
+   LayoutEnv &operator=(const LayoutEnv &other) = delete;
+
+   /* Initializes the buffers of the layout's attributes, GLStage, and GLTexture2DArray (if textured), with space
+      for the provided amount of Quads.
+      capacity - initial amount of Quads to allocate space for (grown as needed)
+   */
+   void init(unsigned capacity) {
+      if (_initialized)
+         throw InitializedException();
+
+      /* initialize members */
+      _glb_modelbuf = GLUtil::GLBuffer(GL_STATIC_DRAW, 16 * sizeof(GLfloat));
+      _glb_elembuf = GLUtil::GLBuffer(GL_STATIC_DRAW, 6 * sizeof(GLuint));
+      _pos.init(capacity);
+      _scale.init(capacity);
+      if constexpr (_has_color)
+         _color.init(capacity);
+      if constexpr (_has_tex) {
+         _texpos.init(capacity);
+         _texsize.init(capacity);
+      }
+      _slots.clear();
+      _slot_offsets = std::vector<unsigned>(capacity, 0);
+      _capacity = capacity;
+      _count = 0;
+      _stats = GLEnvStats{};
+
+      /* set up shader program */
+      const char *shaders[2];
+      shaders[0] = _vert_src.data;
+      shaders[1] = _frag_src.data;
+      GLenum types[2];
+      types[0] = GL_VERTEX_SHADER;
+      types[1] = GL_FRAGMENT_SHADER;
+      _stage.init(shaders, types, 2);
+
+      // set format of model vertices and of the layout's per instance attributes, at the same locations as in GLEnv
+      _stage.setAttribFormat(0, 4, GL_FLOAT, 0, 0);
+      _stage.setAttribFormat(1, 3, GL_FLOAT, 0, 1);
+      _stage.setAttribFormat(2, 3, GL_FLOAT, 0, 1);
+      if constexpr (_has_color)
+         _stage.setAttribFormat(3, 4, GL_FLOAT, 0, 1);
+      if constexpr (_has_tex) {
+         _stage.setAttribFormat(4, 3, GL_FLOAT, 0, 1);
+         _stage.setAttribFormat(5, 2, GL_FLOAT, 0, 1);
+      }
+      for (unsigned i = 0; i <= 5; i++)
+         _stage.setAttribBufferIndex(i, i);
+
+      /* set up buffers */
+
+      // unit quad positioned at (0, 0) to (1, 1)
+      GLfloat data_model[] = {
+         0.0f, 0.0f, 0.0f, 1.0f,
+         1.0f, 0.0f, 0.0f, 1.0f,
+         0.0f, 1.0f, 0.0f, 1.0f,
+         1.0f, 1.0f, 0.0f, 1.0f
+      };
+      GLuint data_elem[] = {
+         0, 1, 2, 1, 2, 3
+      };
+      _glb_modelbuf.subData(sizeof(data_model), data_model, 0);
+      _glb_elembuf.subData(sizeof(data_elem), data_elem, 0);
+      _stage.bindBufferToIndex(_glb_modelbuf.handle(), 0, 0, 4 * sizeof(GLfloat));
+      _bindAttribs();
+      _stage.bindElementBuffer(_glb_elembuf.handle());
+
+      if constexpr (_has_tex)
+         _texarray.init();
+
+      _initialized = true;
+   }
+   void uninit() {
+      if (!_initialized)
+         return;
+
+      _stage.uninit();
+      _texarray.uninit();
+      _glb_modelbuf.uninit();
+      _glb_elembuf.uninit();
+      _pos.uninit();
+      _scale.uninit();
+      _color.uninit();
+      _texpos.uninit();
+      _texsize.uninit();
+      _slots.clear();
+      _slot_offsets.clear();
+      _quad_offsets.clear();
+      _capacity = 0;
+      _count = 0;
+      _initialized = false;
+   }
+
+   /* Generates an active Quad in system, as in GLEnv::genQuad(). Values of attributes not in the layout are
+      ignored. Returns the offset of the Quad, valid until it is removed.
+   */
+   unsigned genQuad(glm::vec3 pos, glm::vec3 scale, glm::vec4 color, glm::vec3 texpos, glm::vec2 texsize) {
+      // if every slot is occupied, double the capacity
+      if (_count >= _capacity)
+         _grow();
+
+      // get a new unique offset, and place it in the first unoccupied slot
+      unsigned offset = _quad_offsets.push();
+      unsigned slot = _count;
+      if (offset >= _slots.size())
+         _slots.push_back(0);
+      _slots[offset] = slot;
+      _slot_offsets[slot] = offset;
+
+      _pos.set(slot, pos);
+      _pos.mark(slot);
+      _scale.set(slot, scale);
+      _scale.mark(slot);
+      if constexpr (_has_color) {
+         _color.set(slot, color);
+         _color.mark(slot);
+      }
+      if constexpr (_has_tex) {
+         _texpos.set(slot, texpos);
+         _texpos.mark(slot);
+         _texsize.set(slot, texsize);
+         _texsize.mark(slot);
+      }
+
+      _count++;
+      return offset;
+   }
+
+   /* Removes the Quad with the provided offset from the system, moving the last active slot into its slot. */
+   void remove(unsigned offset) {
+      unsigned slot = _slot(offset);
+      _quad_offsets.remove(offset);
+
+      unsigned last = _count - 1;
+      if (slot != last) {
+         _pos.move(slot, last);
+         _scale.move(slot, last);
+         if constexpr (_has_color)
+            _color.move(slot, last);
+         if constexpr (_has_tex) {
+            _texpos.move(slot, last);
+            _texsize.move(slot, last);
+         }
+         _slots[_slot_offsets[last]] = slot;
+         _slot_offsets[slot] = _slot_offsets[last];
+      }
+
+      _count--;
+   }
+
+   /* Getters and setters for the values of the Quad with the provided offset; only available for attributes in
+      the layout. */
+   const glm::vec3 &getPos(unsigned offset) { return _pos.get(_slot(offset)); }
+   const glm::vec3 &getScale(unsigned offset) { return _scale.get(_slot(offset)); }
+   const glm::vec4 &getColor(unsigned offset) {
+      static_assert(_has_color, "LayoutEnv layout has no GLL_COLOR");
+      return _color.get(_slot(offset));
+   }
+   const glm::vec3 &getTexPos(unsigned offset) {
+      static_assert(_has_tex, "LayoutEnv layout has no GLL_TEXPOS");
+      return _texpos.get(_slot(offset));
+   }
+   const glm::vec2 &getTexSize(unsigned offset) {
+      static_assert(_has_tex, "LayoutEnv layout has no GLL_TEXSIZE");
+      return _texsize.get(_slot(offset));
+   }
+   void setPos(unsigned offset, glm::vec3 pos) { _pos.set(_slot(offset), pos); }
+   void setScale(unsigned offset, glm::vec3 scale) { _scale.set(_slot(offset), scale); }
+   void setColor(unsigned offset, glm::vec4 color) {
+      static_assert(_has_color, "LayoutEnv layout has no GLL_COLOR");
+      _color.set(_slot(offset), color);
+   }
+   void setTexPos(unsigned offset, glm::vec3 texpos) {
+      static_assert(_has_tex, "LayoutEnv layout has no GLL_TEXPOS");
+      _texpos.set(_slot(offset), texpos);
+   }
+   void setTexSize(unsigned offset, glm::vec2 texsize) {
+      static_assert(_has_tex, "LayoutEnv layout has no GLL_TEXSIZE");
+      _texsize.set(_slot(offset), texsize);
+   }
+
+   /* Texture space setup, as in GLEnv; only available for textured layouts. */
+   void setTexArray(GLuint width, GLuint height, GLuint depth) {
+      static_assert(_has_tex, "LayoutEnv layout is not textured");
+      _texarray.alloc(1, GL_RGBA8, GL_RGBA, GL_UNSIGNED_BYTE, width, height, depth);
+      _stage.uniform3ui(11, glm::uvec3(width, height, depth));
+   }
+   void setTexture(const Image &img, GLuint x_offset, GLuint y_offset, GLuint z_offset) {
+      static_assert(_has_tex, "LayoutEnv layout is not textured");
+      if (img.empty())
+         throw std::runtime_error("Attempt to upload Image with null data");
+      _texarray.subImage(0, x_offset, y_offset, z_offset, img.width(), img.height(), 1, img.data());
+   }
+
+   /* Shader matrices, as in GLEnv. */
+   void setView(glm::mat4 view) { _stage.uniformmat4f(8, view); }
+   void setProj(glm::mat4 proj) { _stage.uniformmat4f(9, proj); }
+
+   /* Window and pixel space, as in GLEnv; only available for ellipse layouts. */
+   void setWindowSpace(GLuint width, GLuint height) {
+      static_assert(_is_ellipse, "LayoutEnv layout does not draw ellipses");
+      _stage.uniform2ui(12, glm::uvec2(width, height));
+   }
+   void setPixelSpace(GLuint width, GLuint height, GLuint depth) {
+      static_assert(_is_ellipse, "LayoutEnv layout does not draw ellipses");
+      _stage.uniform3ui(13, glm::uvec3(width, height, depth));
+   }
+
+   /* Writes changed values of the layout's attributes to their buffers. */
+   void update() {
+      _stats = GLEnvStats{};
+      _pos.upload(_count, _stats);
+      _scale.upload(_count, _stats);
+      if constexpr (_has_color)
+         _color.upload(_count, _stats);
+      if constexpr (_has_tex) {
+         _texpos.upload(_count, _stats);
+         _texsize.upload(_count, _stats);
+      }
+   }
+
+   /* Draws the active Quads with this environment's program and texture array. */
+   void drawQuads() {
+      _stage.use();
+      if constexpr (_has_tex)
+         _texarray.bind(GL_TEXTURE_2D_ARRAY);
+      GLUtil::renderInst(GL_TRIANGLES, 6, _count, true);
+   }
+
+   /* Returns all active offsets in system. (note that this instantiates a vector and will take O(n) time) */
+   std::vector<unsigned> getOffsets() { return _quad_offsets.getUsed(); }
+   /* Returns true if the provided offset is active. */
+   bool hasOffset(unsigned offset) { return offset < _quad_offsets.size() && _quad_offsets.at(offset); }
+   /* Returns the number of Quads space is currently allocated for. */
+   unsigned getCapacity() { return _capacity; }
+   /* Returns the upload counters of the last update() call. */
+   GLEnvStats getStats() { return _stats; }
+   /* Returns whether this instance has been initialized or not. */
+   bool getInitialized() { return _initialized; }
+};
+
+#endif
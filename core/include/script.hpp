@@ -10,12 +10,21 @@
 #include <unordered_set>
 
 #include "commonexcept.hpp"
-#include "managedlist.hpp"
-#include "managedqueue.hpp"
+#include "slabpool.hpp"
 #include "util.hpp"
 
-// prototype
+// prototypes
 class Executor;
+class AllocatorInterface;
+
+/* struct ScriptType
+   Compact handle to a Script name added to an Executor, returned by Executor::add() (and
+   EntityExecutor::addEntity()). Spawning with a handle skips looking up the name.
+*/
+struct ScriptType {
+   unsigned index;
+   // default copy assignment/construction are fine
+};
 
 /* class Script
    Represents a runnable script by an owning Executor instance.
@@ -28,14 +37,23 @@ class Script {
    // fields maintained by owning Executor
    Executor *_executor;
    unsigned _executor_id;
-   std::list<Script*>::iterator _this_iter;
+   // allocator that allocated the Script, and releases it on erasure
+   AllocatorInterface *_allocator;
+   // links into the owning Executor's list of Scripts
+   Script *_prev_script;
+   Script *_next_script;
    int _last_execqueue;
+   // queue the Script runs on every call of runExecQueue() (-1 if none), and its index in the queue's dense array
+   int _persistent_queue;
+   unsigned _persistent_index;
    bool _remove_on_kill;
+   bool _recycle;
    bool _initialized;
    bool _killed;
    bool _exec_enqueued;
    bool _kill_enqueued; 
-   std::string _script_name;
+   // handle of the name the Script was spawned with
+   ScriptType _script_type;
 
    // settable integer usable for identification
    int _group;
@@ -52,6 +70,17 @@ protected:
    virtual void _base() = 0;
    virtual void _kill() = 0;
 
+   /* Called by the owning Executor when a killed, recycled Script is respawned, before it is set up again (see
+      Executor::setRecycle()). Should restore the state the Script had after construction; resources kept from the
+      previous spawn (and subscriptions made by its allocator) can be kept. Does nothing by default.
+   */
+   virtual void _reset();
+   /* Called by the owning Executor before a killed, recycled Script is handed back to its allocator instead of being
+      respawned (when recycling is turned off, or on uninit()). Should release resources kept from the previous spawn
+      for reuse. Does nothing by default.
+   */
+   virtual void _release();
+
 public:
    Script(Script &&other);
    Script();
@@ -78,6 +107,14 @@ public:
    /* Kills the Script. */
    void enqueueKill();
 
+   /* Makes the Script run on every execution of the provided queue until it is killed or paused, without being
+      enqueued again.
+      - queue - queue to run on
+   */
+   void enqueuePersistent(unsigned queue);
+   /* Stops the Script from running on its persistent queue. */
+   void pausePersistent();
+
    /* Sets various internal flags used by Executors to control state. Can be set manually to manipulate
       execution behavior.
    */
@@ -86,7 +123,13 @@ public:
    bool getKilled();
    bool getExecEnqueued();
    bool getKillEnqueued();
+   /* Returns whether the Script runs on every execution of a queue (see enqueuePersistent()). */
+   bool getPersistent();
+   int getPersistentQueue();
+   /* Returns whether the Script is kept for reuse by a later spawn after being killed, instead of being released. */
+   bool getRecycle();
    const char *getName();
+   ScriptType getType();
    int getGroup();
    Executor &executor();
    unsigned getExecutorID();
@@ -96,7 +139,8 @@ public:
 
 /* abstract class AllocatorInterface
    Is used to invoke allocate(), which must return heap-allocated memory to be owned
-   by the invoking Executor instance.
+   by the invoking Executor instance. The Executor hands instances back to deallocate() when
+   erasing them, so allocators must outlive the Scripts they allocate.
 */
 class Executor;
 class AllocatorInterface {
@@ -104,6 +148,14 @@ class AllocatorInterface {
 protected:
    /* Must return a heap-allocated instance of a covariant type of Script. */
    virtual Script *_allocate(int tag) = 0;
+   /* Releases an instance returned by _allocate(). Deletes it by default; must be overridden if _allocate() does
+      not use new.
+   */
+   virtual void _deallocate(Script *script) { delete script; }
+   /* Called in place of _allocate() when a recycled instance is respawned with the provided tag. Does nothing by
+      default.
+   */
+   virtual void _reuse(Script *script, int tag) {}
    // no members; no need for constructor/assignment/destructor definitions
 };
 
@@ -117,6 +169,17 @@ class GenericAllocator : public AllocatorInterface {
    // no members; no need for constructor/assignment/destructor definitions
 };
 
+/* class PooledAllocator
+   An implementation of the AllocatorInterface that allocates instances from a SlabPool, so that
+   spawning and erasing them does not allocate once the pool has grown to the number of live instances.
+*/
+template<class T>
+class PooledAllocator : public AllocatorInterface {
+   SlabPool<T> _pool;
+   Script *_allocate(int tag) override { return _pool.alloc(); }
+   void _deallocate(Script *script) override { _pool.free(static_cast<T*>(script)); }
+};
+
 // --------------------------------------------------------------------------------------------------------------------------
 
 /* class Executor
@@ -125,64 +188,94 @@ class GenericAllocator : public AllocatorInterface {
    for execution can be specified.
 */
 class Executor {
-   // struct holding Script information mapped to a name
+   // struct holding Script information of an added name, indexed by ScriptType
    struct ScriptInfo {
+      std::string _name;
       int _group;
       bool _remove_on_kill;
+      bool _recycle;
+      bool _persistent;
       AllocatorInterface *_allocator;
       std::function<void(Script*)> _spawn_callback;
       std::function<void(Script*)> _remove_callback;
+      // killed Scripts kept for reuse, if recycling
+      std::vector<Script*> _recycled;
       // default copy assignment/construction are fine
    };
 
 protected:
-   // class to store enqueues and polymorphically spawn later
-   class ScriptEnqueue {
-      friend Executor;
-      Executor *_executor;
-   protected:
-      std::string _name;
+   // record of an enqueued spawn, stored by value until spawned
+   struct SpawnRecord {
+      ScriptType _type;
       int _execution_queue;
       int _tag;
-      virtual Script *spawn();
-      ScriptEnqueue(Executor *executor, std::string name, int execution_queue, int tag);
-      // default copy assignment/construction are fine (copying implies another enqueue in the same Executor)
-   public:
-      virtual ~ScriptEnqueue();
+      // index of additional data stored by subclasses for the spawn
+      unsigned _data;
+      // default copy assignment/construction are fine
    };
 
 private:
    /* Script data structures */
-   // memory-managed list of Script references and IntGenerator to provide Scripts with unique identifiers
-   ManagedList<Script> _scripts;
+   // intrusive list of owned Scripts (linked through the Scripts themselves, so that no nodes are allocated) 
+   // and IntGenerator to provide Scripts with unique identifiers
+   Script *_scripts;
+   unsigned _script_count;
    IntGenerator _intgen;
 
-   // internal variables for added script information and active scripts
-   std::unordered_map<std::string, ScriptInfo> _scriptinfos;
-   ManagedQueue<ScriptEnqueue> _scriptenqueues;
+   // information of added Script names indexed by ScriptType, and handles of the names
+   std::vector<ScriptInfo> _scriptinfos;
+   std::unordered_map<std::string, unsigned> _scripttypes;
 
-   // queues of Scripts to be executed; swapped on execution
+   // spawns enqueued since the last runSpawnQueue(), and Scripts spawned by it
+   std::vector<SpawnRecord> _spawnrecords;
+   std::vector<Script*> _spawned;
+
+   // queues of Scripts to be executed; swapped on execution, and cleared after running so that both buffers keep
+   // their capacity across runs and enqueueing does not allocate once they have grown
    struct QueuePair {
-      std::queue<Script*> _push_execqueue;
-      std::queue<Script*> _run_execqueue;
+      std::vector<Script*> _push_execqueue;
+      std::vector<Script*> _run_execqueue;
+      // dense array of Scripts run on every execution; removed Scripts leave null slots until the next execution
+      std::vector<Script*> _persistent;
+      unsigned _persistent_removed;
    };
    std::vector<QueuePair> _queuepairs;
    
-   // queue of Scripts to be erased
-   std::queue<Script*> _push_killqueue;
-   std::queue<Script*> _run_killqueue;
+   // queue of Scripts to be erased, buffered the same way
+   std::vector<Script*> _push_killqueue;
+   std::vector<Script*> _run_killqueue;
 
    bool _initialized;
 
+   // links a Script into and out of the list of owned Scripts
+   void _linkScript(Script *script);
+   void _unlinkScript(Script *script);
+
+   // removes a Script from its persistent queue, if any
+   void _removePersistent(Script *script);
+   // removes the null slots left in the persistent array of a queue, updating the indices of moved Scripts
+   void _compactPersistent(QueuePair &queuepair);
+
 protected:
+   // takes a recycled Script of the provided type and resets it to be spawned again, or returns nullptr if there are none
+   Script *_takeRecycled(ScriptType type, int tag);
+
    // initializes Script's Executor-related fields
-   void _setupScript(Script *script, const char *script_name, int execution_queue);
+   void _setupScript(Script *script, AllocatorInterface *allocator, ScriptType type, int execution_queue);
+
+   // spawns a Script of a type previously added to this manager, and returns it
+   Script *_spawnScript(ScriptType type, int execution_queue, int tag);
 
-   // spawns a Script using a name previously added to this manager, and returns its ID
-   Script *_spawnScript(const char *script_name, int execution_queue, int tag);
+   // pushes a spawn record
+   void _pushSpawnRecord(SpawnRecord record);
 
-   // pushes an enqueue
-   void _pushSpawnEnqueue(ScriptEnqueue *enqueue);
+   // spawns the Script of a record; overridden by subclasses storing additional data for spawns
+   virtual Script *_spawnRecord(const SpawnRecord &record);
+   // clears spawn records once spawned; overridden by subclasses to clear their additional data
+   virtual void _clearSpawnRecords();
+
+   // checks that the provided ScriptType was returned by this Executor; throws if not
+   void _checkType(ScriptType type);
 
    // checks if the provided Script belongs to this Executor; throws if not
    void _checkOwned(Script *script);
@@ -204,7 +297,8 @@ public:
    void init(unsigned queues);
    void uninit();
 
-   /* Erases the passed Script. The reference becomes invalid after this is called.
+   /* Erases the passed Script, handing it back to its allocator (or keeping it for reuse if it was killed and its name
+      is recycling). The reference becomes invalid after this is called.
    */
    void erase(Script *script);
 
@@ -216,29 +310,61 @@ public:
       - removeonkill - removes this Script from this manager when it is killed
       - spawn_callback - function callback to call after Script has been spawned and setup
       - remove_callback - function callback to call before Script has been removed
+      Returns a handle to the name that can be used to spawn the Script without looking up the name.
+   */
+   ScriptType add(AllocatorInterface *allocator, const char *name, int group, bool remove_on_kill, std::function<void(Script*)> spawn_callback, std::function<void(Script*)> remove_callback);
+
+   /* Sets whether Scripts of the provided name are recycled. When recycling, Scripts erased after being killed are
+      kept instead of being handed back to their allocator, and later spawns of the name reuse them (calling their
+      _reset() method) before allocating new ones, skipping construction and destruction. Kept Scripts also keep
+      their resources (e.g. Entities keep their Quads, which are still drawn, hidden, until reused) until they are
+      reused, or released by their _release() method when recycling is turned off or on uninit().
+   */
+   void setRecycle(const char *name, bool recycle);
+
+   /* Sets whether Scripts of the provided name are persistent. Persistent Scripts spawned with a non-negative
+      execution queue run on every execution of that queue (see enqueuePersistent()) instead of being enqueued once.
    */
-   void add(AllocatorInterface *allocator, const char *name, int group, bool remove_on_kill, std::function<void(Script*)> spawn_callback, std::function<void(Script*)> remove_callback);
+   void setPersistent(const char *name, bool persistent);
 
-   /* Enqueues a Script to be spawned when calling runSpawnQueue(). */
+   /* Enqueues a Script to be spawned when calling runSpawnQueue(). Spawns are recorded by value, so that enqueueing
+      does not allocate once the record buffer has grown to the number of spawns per call of runSpawnQueue().
+   */
+   void enqueueSpawn(ScriptType type, int execution_queue, int tag);
    void enqueueSpawn(const char *script_name, int execution_queue, int tag);
    /* Enqueues a Script instance to be executed when runExecQueue() is called. */
    void enqueueExec(Script *script, unsigned queue);
    /* Enqueues a Script instance to be killed when runKillQueue() is called. */
    void enqueueKill(Script *script);
+   /* Makes a Script instance run on every call of runExecQueue() with the provided queue (moving it from another
+      persistent queue if needed), until it is killed or paused with pausePersistent(). Scripts are kept in a dense
+      array per queue, so that they do not need to be enqueued again every execution; enqueueExec() does nothing
+      for a Script already persistent on the queue.
+   */
+   void enqueuePersistent(Script *script, unsigned queue);
+   /* Stops a Script instance from running on its persistent queue. Does nothing if it is not persistent. */
+   void pausePersistent(Script *script);
 
-   /* Executes all currently enqueued Scripts in the specified queue, and dequeues them. This will call the 
-      (init() method if it has not yet been called, and the) base() method on every active Script.
+   /* Executes all Scripts persistent on the specified queue, then all currently enqueued Scripts in it, and dequeues
+      them. This will call the (init() method if it has not yet been called, and the) base() method on every active
+      Script.
    */
    void runExecQueue(unsigned queue);
    /* Calls the kill() method on all erasure-queued Scripts if it has not been called yet. */
    void runKillQueue();
-   /* Spawns all Scripts (or sub classes) queued for spawning with spawnScriptEnqueue(). */
-   std::vector<Script*> runSpawnQueue();
+   /* Spawns all Scripts (or sub classes) queued for spawning with enqueueSpawn(), including ones enqueued while
+      spawning. Returns the spawned Scripts; the reference is valid until the next call.
+   */
+   const std::vector<Script*> &runSpawnQueue();
 
    /* Returns true if the provided Script reference is owned by this instance. */
    bool has(Script *script);
    /* Returns true if the provided Script name has been previously added to this manager. */
    bool hasAdded(const char *script_name);
+   /* Returns the handle of a Script name previously added to this manager. */
+   ScriptType getType(const char *script_name);
+   /* Returns the name of a handle. */
+   const char *getTypeName(ScriptType type);
    /* Returns the number of Scripts in this executor. */
    unsigned getCount();
    /* Returns number of execution queues in this executor. */
@@ -367,6 +493,12 @@ class ProvidedAllocator : public AllocatorInterface {
    Script *_allocate(int tag) override {
       return _allocateStore(tag);
    }
+   void _deallocate(Script *script) override {
+      _deallocateProvided(static_cast<T*>(script));
+   }
+   void _reuse(Script *script, int tag) override {
+      _reuseStore(static_cast<T*>(script), tag);
+   }
 
 protected:
    T * _allocateStore(int tag) {
@@ -379,7 +511,15 @@ protected:
       return t;
    }
 
+   // gives a recycled T to the provider again, as if it had just been allocated
+   void _reuseStore(T *t, int tag) {
+      if (_a_provider)
+         _a_provider->_storeType(t, tag);
+   }
+
    virtual T *_allocateProvided() = 0;
+   /* Releases an instance returned by _allocateProvided(). Deletes it by default. */
+   virtual void _deallocateProvided(T *t) { delete t; }
 
    ProvidedAllocator() : _a_provider(nullptr) {}
    ProvidedAllocator(ProvidedAllocator<T> &&other) { operator=(std::move(other)); }
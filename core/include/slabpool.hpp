@@ -0,0 +1,107 @@
+#ifndef SLABPOOL_HPP_
+#define SLABPOOL_HPP_
+
+#include <memory>
+#include <new>
+#include <utility>
+#include <vector>
+
+// default number of instances allocated per slab
+#define SLABPOOL_SLAB_SIZE 64
+
+/* class SlabPool
+   Allocates instances of T from slabs of contiguous slots, each slab holding a fixed number of instances.
+   Released slots are kept on a free list and reused (most recently released first) by later allocations, so
+   that allocating and releasing instances involves no heap allocations once enough slabs exist, and live
+   instances sit close together in memory. Slabs are only released when the pool is destroyed.
+
+   Instances must be released with free() before the pool is destroyed; the pool does not destroy instances
+   still allocated from it.
+*/
+template<class T>
+class SlabPool {
+    // slot holding either an instance or, when free, the next free slot
+    union Slot {
+        Slot *_next_free;
+        alignas(T) unsigned char _storage[sizeof(T)];
+    };
+
+    std::vector<std::unique_ptr<Slot[]>> _slabs;
+    Slot *_free;
+    unsigned _slab_size;
+    unsigned _count;
+
+    // allocates a slab and links its slots into the free list, in address order
+    void _grow() {
+        Slot *slab = new Slot[_slab_size];
+        _slabs.emplace_back(slab);
+        for (unsigned i = 0; i < _slab_size - 1; i++)
+            slab[i]._next_free = &(slab[i + 1]);
+        slab[_slab_size - 1]._next_free = _free;
+        _free = slab;
+    }
+
+public:
+    /* slab_size - number of instances allocated at once whenever the pool runs out of free slots */
+    SlabPool(unsigned slab_size) : _free(nullptr), _slab_size(slab_size > 0 ? slab_size : 1), _count(0) {}
+    SlabPool() : SlabPool(SLABPOOL_SLAB_SIZE) {}
+    SlabPool(SlabPool &&other) : SlabPool() { operator=(std::move(other)); }
+    SlabPool(const SlabPool &other) = delete;
+    ~SlabPool() { /* automatic destruction is fine */ }
+
+    SlabPool &operator=(SlabPool &&other) {
+        if (this != &other) {
+            _slabs = std::move(other._slabs);
+            _free = other._free;
+            _slab_size = other._slab_size;
+            _count = other._count;
+            other._slabs.clear();
+            other._free = nullptr;
+            other._count = 0;
+        }
+        return *this;
+    }
+    SlabPool &operator=(const SlabPool &other) = delete;
+
+    /* Constructs an instance of T with the provided arguments in a free slot, allocating a slab if there are
+       none, and returns its address.
+    */
+    template<typename... Args>
+    T *alloc(Args&&... args) {
+        if (!_free)
+            _grow();
+
+        Slot *slot = _free;
+        _free = slot->_next_free;
+
+        // return the slot if construction throws
+        T *t;
+        try {
+            t = new (slot->_storage) T(std::forward<Args>(args)...);
+        } catch (...) {
+            slot->_next_free = _free;
+            _free = slot;
+            throw;
+        }
+
+        _count++;
+        return t;
+    }
+
+    /* Destroys an instance previously returned by alloc(), and returns its slot to the free list. */
+    void free(T *t) {
+        t->~T();
+
+        Slot *slot = reinterpret_cast<Slot*>(t);
+        slot->_next_free = _free;
+        _free = slot;
+        _count--;
+    }
+
+    /* Returns the number of instances currently allocated. */
+    unsigned size() { return _count; }
+    /* Returns the number of instances that can be allocated before allocating another slab. */
+    unsigned capacity() { return _slabs.size() * _slab_size; }
+};
+
+#endif
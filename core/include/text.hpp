@@ -31,10 +31,12 @@ struct TextConfig {
     // default copy assignment/construction are fine
 };
 
-/* collection of quads to represent text */
+/* collection of quads to represent text, generated as one contiguous range (see GLEnv::genQuads()) */
 class Text {
     GLEnv *_glenv;
-    std::vector<int> _quadids;
+    // first offset and number of Quads in range
+    unsigned _first_quad;
+    unsigned _quad_count;
 
     TextConfig _tc;
 
@@ -0,0 +1,127 @@
+#ifndef TEXTENV_HPP_
+#define TEXTENV_HPP_
+
+#include <cstring>
+#include "layoutenv.hpp"
+#include "text.hpp"
+
+/* class TextEnv
+   Renders strings of text as single instances, instead of one GLEnv Quad per character. Each string is one
+   instance with a position, scale, color and font, and its characters are stored as packed glyph indices (one byte
+   each, four per word) in a shader storage buffer; fonts (TextConfig values) are stored once in another. The vertex
+   shader pulls the glyph of each character from the storage and expands it into a quad, laid out and centered as
+   Text does, so that all strings are drawn with a single instanced call without vertex buffers.
+
+   Only the words of characters that changed are written by update(), so that the cost of text scales with the
+   number of characters changed rather than displayed. Each string reserves room for its glyphs with a
+   RangeGenerator, doubling it when outgrown.
+
+   Strings are textured from the texture array of a GLEnv, and must be drawn after it (into the same target, as
+   drawText() does not set any). Characters are expected in the order of ASCII, starting with the space character,
+   as with Text.
+
+   It is undefined behavior to make method calls (except for uninit()) on instances
+   of this class without calling init() first.
+*/
+class TextEnv {
+   /* environment structures */
+   GLUtil::GLStage _stage;
+   // environment whose texture array fonts are read from
+   GLEnv *_glenv;
+
+   /* fonts */
+   std::vector<TextConfig> _fonts;
+   GLUtil::GLBuffer _glb_fonts;
+
+   /* per string attributes (instanced), indexed by string offset */
+   LayoutArray<glm::vec3> _pos;
+   LayoutArray<glm::vec3> _scale;
+   LayoutArray<glm::vec4> _color;
+   // font, first glyph word, length, and unused
+   LayoutArray<glm::uvec4> _text;
+
+   /* glyphs */
+   // glyph indices packed four per word (lowest byte first), in shader storage
+   LayoutArray<GLuint> _glyphs;
+   // words reserved by each string
+   RangeGenerator _glyph_words;
+   unsigned _glyph_capacity;
+
+   /* strings */
+   // current text and number of words reserved of each string (indexed by offset)
+   std::vector<std::string> _strings;
+   std::vector<unsigned> _string_words;
+   IntGenerator _string_offsets;
+   unsigned _capacity;
+   // length of the longest active string, determining the number of vertices drawn per instance
+   unsigned _max_length;
+
+   // counters of the last update
+   GLEnvStats _stats;
+
+   // flag to prevent moved TextEnv instances from doing anything
+   bool _initialized;
+
+   // binds the buffers of the per string attributes to their buffer indices
+   void _bindAttribs();
+
+   // returns the offset if it is active, throwing otherwise
+   unsigned _string(unsigned offset);
+
+   // reserves the provided number of words for the glyphs of a string, moving its glyphs if they must be relocated
+   void _reserveWords(unsigned offset, unsigned words);
+
+   // writes the glyph index of a character of a string, marking its word if it changed
+   void _setGlyph(unsigned offset, unsigned index, unsigned char glyph);
+
+public:
+   /* Calls init() with the provided arguments. */
+   TextEnv(GLEnv *glenv, unsigned capacity);
+   TextEnv(TextEnv &&other);
+   TextEnv();
+   TextEnv(const TextEnv &other) = delete;
+   ~TextEnv();
+
+   TextEnv &operator=(TextEnv &&other);
+   TextEnv &operator=(const TextEnv &other) = delete;
+
+   /* Initializes buffers and GLStage, with space for the provided amount of strings.
+      glenv - environment to read the texture array from
+      capacity - initial amount of strings to allocate space for (grown as needed)
+   */
+   void init(GLEnv *glenv, unsigned capacity);
+   void uninit();
+
+   /* Adds a font, and returns its index. */
+   unsigned addFont(TextConfig config);
+
+   /* Generates an empty string, drawn with the provided font. Returns the offset of the string, valid until it is
+      removed. */
+   unsigned genText(unsigned font);
+   /* Removes the string with the provided offset, freeing its glyphs. */
+   void remove(unsigned offset);
+
+   /* Sets the text of a string. Only characters that differ from the current text are written by the next update(). */
+   void setText(unsigned offset, const char *str);
+   void setPos(unsigned offset, glm::vec3 pos);
+   void setScale(unsigned offset, glm::vec3 scale);
+   void setColor(unsigned offset, glm::vec4 color);
+   void setFont(unsigned offset, unsigned font);
+
+   const std::string &getText(unsigned offset);
+
+   void setView(glm::mat4 view);
+   void setProj(glm::mat4 proj);
+
+   /* Writes changed string attributes and glyph words into graphic memory. */
+   void update();
+   /* Draws every string with a single instanced call. */
+   void drawText();
+
+   bool hasOffset(unsigned offset);
+   bool getInitialized();
+   /* Returns the upload counters of the last update() call. */
+   GLEnvStats getStats();
+};
+
+#endif
@@ -7,6 +7,7 @@
 #include <vector>
 #include <string>
 #include <queue>
+#include <map>
 
 #define PI_UTIL 3.14159265358979323846264338327950288
 
@@ -29,22 +30,26 @@ class Image {
 public:
     Image(const char *filename);
     Image(const Image &other);
+    Image(Image &&other);
     Image();
-    Image(Image &&other) = delete;
     ~Image();
 
     Image& operator=(const Image &other);
-    Image& operator=(Image &&other) = delete;
+    Image& operator=(Image &&other);
 
+    /* Loads RGBA image data from the file, replacing any held data. */
     void load(const char *filename);
     void free();
 
+    /* Returns a copy of the image data, allocated with new[] (to be released with delete[]). */
     unsigned char* copyData() const;
-    int width();
-    int height();
-    int components();
-    int size();
-    bool empty();
+    /* Returns a read only view of the image data (null if empty), valid until the Image is freed or reassigned. */
+    const unsigned char* data() const;
+    int width() const;
+    int height() const;
+    int components() const;
+    int size() const;
+    bool empty() const;
 };
 
 /* class IntGenerator
@@ -91,6 +96,57 @@ public:
     unsigned activeSize();
 };
 
+/* class RangeGenerator
+   Provides and manages unique integers like IntGenerator, but can also provide contiguous ranges of them. Free 
+   integers are kept as ranges sorted by their first integer (merged with adjacent free ranges on removal), and each
+   request takes the first free range that is large enough, or grows past the end.
+*/
+class RangeGenerator {
+    //main ID vector
+    std::vector<bool> _ids;
+    //free ranges of IDs, as the number of IDs in each range keyed by its first ID
+    std::map<unsigned, unsigned> _free_ranges;
+    unsigned _free_count;
+
+public:
+    RangeGenerator();
+    ~RangeGenerator();
+
+    // default copy assignment/construction are fine
+
+    /* Occupies an ID and returns it. */
+    unsigned push();
+
+    /* Occupies count contiguous IDs and returns the first. Throws if count is 0. */
+    unsigned pushRange(unsigned count);
+
+    /* Frees ID i. Throws if it is not active. */
+    void remove(unsigned i);
+
+    /* Frees count contiguous IDs starting at ID first. Throws if count is 0 or any of them is not active. */
+    void removeRange(unsigned first, unsigned count);
+
+    /* Returns a vector of all indices that are true. */
+    std::vector<unsigned> getUsed();
+
+    /* Empties IDs and free ranges. */
+    void clear();
+
+    /* Returns whether ID i is active or not. */
+    bool at(unsigned i);
+    bool operator[](unsigned i);
+
+    /* Returns true if active IDs are empty. */
+    bool empty();
+
+    /* Returns count of IDs (includes free IDs). */
+    unsigned size();
+    /* Returns count of free IDs. */
+    unsigned freeSize();
+    /* Returns count of active IDs. */
+    unsigned activeSize();
+};
+
 template<typename T>
 class IntgenVector {
     std::vector<T> _data;
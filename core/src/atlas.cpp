@@ -0,0 +1,96 @@
+#include "../include/atlas.hpp"
+
+bool Atlas::_fit(const std::vector<Segment> &skyline, unsigned index, unsigned width, unsigned height, unsigned &y) {
+    unsigned x = skyline[index].x;
+    if (x + width > _width)
+        return false;
+
+    // rectangle rests on the lowest free row of the segments it spans
+    y = 0;
+    unsigned remaining = width;
+    for (unsigned i = index; remaining > 0; i++) {
+        y = std::max(y, skyline[i].y);
+        if (y + height > _height)
+            return false;
+        remaining -= std::min(remaining, skyline[i].width);
+    }
+    return true;
+}
+
+void Atlas::_place(std::vector<Segment> &skyline, unsigned index, unsigned y, unsigned width, unsigned height) {
+    unsigned x = skyline[index].x;
+    skyline.insert(skyline.begin() + index, Segment{ x, y + height, width });
+
+    // cut the segments now covered by the rectangle
+    unsigned end = x + width;
+    unsigned i = index + 1;
+    while (i < skyline.size() && skyline[i].x < end) {
+        unsigned covered = end - skyline[i].x;
+        if (skyline[i].width <= covered) {
+            skyline.erase(skyline.begin() + i);
+            continue;
+        }
+        skyline[i].x += covered;
+        skyline[i].width -= covered;
+        break;
+    }
+
+    // merge neighboring segments of the same row
+    for (i = 0; i + 1 < skyline.size();) {
+        if (skyline[i].y == skyline[i + 1].y) {
+            skyline[i].width += skyline[i + 1].width;
+            skyline.erase(skyline.begin() + i + 1);
+        } else
+            i++;
+    }
+}
+
+Atlas::Atlas(unsigned width, unsigned height, unsigned depth) {
+    reset(width, height, depth);
+}
+Atlas::Atlas() : _width(0), _height(0) {}
+Atlas::~Atlas() { /* automatic destruction is fine */ }
+
+void Atlas::reset(unsigned width, unsigned height, unsigned depth) {
+    _width = width;
+    _height = height;
+    _skylines.assign(depth, std::vector<Segment>{ Segment{ 0, 0, width } });
+}
+
+void Atlas::reserveLayer(unsigned layer) {
+    if (layer >= _skylines.size())
+        throw std::out_of_range("Index out of range");
+
+    _skylines[layer].clear();
+}
+
+AtlasRegion Atlas::pack(unsigned width, unsigned height) {
+    for (unsigned layer = 0; layer < _skylines.size(); layer++) {
+        std::vector<Segment> &skyline = _skylines[layer];
+
+        // find the segment to start the rectangle at with the highest bottom edge, then the leftmost one
+        bool found = false;
+        unsigned best_index = 0;
+        unsigned best_y = 0;
+        for (unsigned i = 0; i < skyline.size(); i++) {
+            unsigned y;
+            if (_fit(skyline, i, width, height, y) && (!found || y < best_y)) {
+                found = true;
+                best_index = i;
+                best_y = y;
+            }
+        }
+
+        if (found) {
+            AtlasRegion region{ glm::vec3(skyline[best_index].x, best_y, layer), glm::vec2(width, height) };
+            _place(skyline, best_index, best_y, width, height);
+            return region;
+        }
+    }
+
+    throw std::runtime_error("Attempt to pack rectangle into full Atlas");
+}
+
+unsigned Atlas::width() { return _width; }
+unsigned Atlas::height() { return _height; }
+unsigned Atlas::depth() { return _skylines.size(); }
@@ -0,0 +1,146 @@
+#include "../include/eglstate.hpp"
+
+EGLErrorException::EGLErrorException(const char *call) : std::runtime_error(std::string("EGL error in ") + call) {}
+
+// returns whether an extension is listed in an EGL extension string
+static bool hasEGLExtension(const char *extensions, const char *name) {
+    if (!extensions)
+        return false;
+
+    size_t length = std::strlen(name);
+    for (const char *found = std::strstr(extensions, name); found; found = std::strstr(found + length, name))
+        if ((found == extensions || found[-1] == ' ') && (found[length] == ' ' || found[length] == '\0'))
+            return true;
+    return false;
+}
+
+EGLState::EGLState(int width, int height, bool debug) :
+    _display(EGL_NO_DISPLAY), _context(EGL_NO_CONTEXT), _surface(EGL_NO_SURFACE), _width(0), _height(0)
+{
+    init(width, height, debug);
+}
+EGLState::EGLState() : _display(EGL_NO_DISPLAY), _context(EGL_NO_CONTEXT), _surface(EGL_NO_SURFACE), _width(0), _height(0) {}
+EGLState::~EGLState() {
+    uninit();
+}
+
+void EGLState::init(int width, int height, bool debug) {
+    if (_display != EGL_NO_DISPLAY)
+        throw std::runtime_error("Attempt to initialize EGLState with existing EGLDisplay");
+
+    // get a display that needs no window system, if the platform is available
+    const char *client_extensions = eglQueryString(EGL_NO_DISPLAY, EGL_EXTENSIONS);
+    PFNEGLGETPLATFORMDISPLAYEXTPROC getPlatformDisplay =
+        (PFNEGLGETPLATFORMDISPLAYEXTPROC)eglGetProcAddress("eglGetPlatformDisplayEXT");
+    if (getPlatformDisplay && hasEGLExtension(client_extensions, "EGL_MESA_platform_surfaceless"))
+        _display = getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, NULL);
+    else
+        _display = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+    if (_display == EGL_NO_DISPLAY || !eglInitialize(_display, NULL, NULL)) {
+        _display = EGL_NO_DISPLAY;
+        throw EGLErrorException("eglInitialize()");
+    }
+
+    const char *extensions = eglQueryString(_display, EGL_EXTENSIONS);
+    bool surfaceless = hasEGLExtension(extensions, "EGL_KHR_surfaceless_context");
+
+    // choose a configuration usable with desktop OpenGL and pbuffers, or none if the display has none and the 
+    // context can be made current without one
+    EGLint config_attribs[] = {
+        EGL_SURFACE_TYPE, EGL_PBUFFER_BIT,
+        EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT,
+        EGL_RED_SIZE, 8,
+        EGL_GREEN_SIZE, 8,
+        EGL_BLUE_SIZE, 8,
+        EGL_ALPHA_SIZE, 8,
+        EGL_DEPTH_SIZE, 24,
+        EGL_NONE
+    };
+    EGLConfig config = EGL_NO_CONFIG_KHR;
+    EGLint config_count = 0;
+    eglChooseConfig(_display, config_attribs, &config, 1, &config_count);
+    if (config_count == 0) {
+        if (!surfaceless || !hasEGLExtension(extensions, "EGL_KHR_no_config_context")) {
+            uninit();
+            throw EGLErrorException("eglChooseConfig()");
+        }
+        config = EGL_NO_CONFIG_KHR;
+    }
+
+    // create an OpenGL 4.6 core context, or 4.5 if unsupported
+    if (!eglBindAPI(EGL_OPENGL_API)) {
+        uninit();
+        throw EGLErrorException("eglBindAPI()");
+    }
+    for (EGLint minor = 6; minor >= 5 && _context == EGL_NO_CONTEXT; minor--) {
+        EGLint context_attribs[] = {
+            EGL_CONTEXT_MAJOR_VERSION, 4,
+            EGL_CONTEXT_MINOR_VERSION, minor,
+            EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+            EGL_CONTEXT_OPENGL_DEBUG, debug ? EGL_TRUE : EGL_FALSE,
+            EGL_NONE
+        };
+        _context = eglCreateContext(_display, config, EGL_NO_CONTEXT, context_attribs);
+    }
+    if (_context == EGL_NO_CONTEXT) {
+        uninit();
+        throw EGLErrorException("eglCreateContext()");
+    }
+
+    // make current without a surface if possible, otherwise with a pbuffer of the target size
+    if (!surfaceless) {
+        EGLint surface_attribs[] = { EGL_WIDTH, width, EGL_HEIGHT, height, EGL_NONE };
+        _surface = eglCreatePbufferSurface(_display, config, surface_attribs);
+        if (_surface == EGL_NO_SURFACE) {
+            uninit();
+            throw EGLErrorException("eglCreatePbufferSurface()");
+        }
+    }
+    if (!eglMakeCurrent(_display, _surface, _surface, _context)) {
+        uninit();
+        throw EGLErrorException("eglMakeCurrent()");
+    }
+
+    _width = width;
+    _height = height;
+}
+
+void EGLState::uninit() {
+    if (_display == EGL_NO_DISPLAY)
+        return;
+
+    // framebuffer must be deleted while the context is current
+    if (_context != EGL_NO_CONTEXT) {
+        _target.uninit();
+        GLUtil::setDefaultFramebuffer(0);
+    }
+
+    eglMakeCurrent(_display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+    if (_surface != EGL_NO_SURFACE)
+        eglDestroySurface(_display, _surface);
+    if (_context != EGL_NO_CONTEXT)
+        eglDestroyContext(_display, _context);
+    eglTerminate(_display);
+
+    _display = EGL_NO_DISPLAY;
+    _context = EGL_NO_CONTEXT;
+    _surface = EGL_NO_SURFACE;
+    _width = 0;
+    _height = 0;
+}
+
+void EGLState::initTarget() {
+    _target.init(_width, _height);
+    GLUtil::setDefaultFramebuffer(_target.handle());
+
+    // bind it with a viewport of its size, as a window's framebuffer would be initially
+    _target.bind();
+}
+
+void EGLState::finish() {
+    glFinish();
+}
+
+GLUtil::GLFramebuffer &EGLState::getTarget() { return _target; }
+
+bool EGLState::isSurfaceless() { return _surface == EGL_NO_SURFACE; }
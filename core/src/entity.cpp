@@ -33,50 +33,71 @@ void Entity::_kill() {
         _killEntity();
 }
 
-EntityExecutor &Entity::executor() { return *_entityexecutor; }
-
-// --------------------------------------------------------------------------------------------------------------------------
+void Entity::_reset() {
+    if (_entityexecutor)
+        _resetEntity();
+}
 
-Entity *EntityExecutor::EntityEnqueue::spawn() {
-    return _entityexecutor->_spawnEntity(_name.c_str(), _execution_queue, _tag, _transform);
+void Entity::_release() {
+    if (_entityexecutor)
+        _releaseEntity();
 }
 
-EntityExecutor::EntityEnqueue::EntityEnqueue(EntityExecutor *entityexecutor, std::string name, int execution_queue, int tag, Transform transform) :
-    ScriptEnqueue(nullptr, name, execution_queue, tag), _entityexecutor(entityexecutor), _transform(transform)
-{}
+void Entity::_resetEntity() {}
+void Entity::_releaseEntity() {}
+
+EntityExecutor &Entity::executor() { return *_entityexecutor; }
+
+// --------------------------------------------------------------------------------------------------------------------------
 
-void EntityExecutor::_setupEntity(Entity *entity, const char *entity_name) {
+void EntityExecutor::_setupEntity(Entity *entity) {
     // set up entity fields
     entity->_entityexecutor = this;
 }
 
-Entity *EntityExecutor::_spawnEntity(const char *entity_name, int execution_queue, int tag, Transform transform) {
-    // allocate instance and set it up
-    Entity *entity = _entityinfos[entity_name]._allocator->_allocate(tag);
-    _setupScript(entity, entity_name, execution_queue);
-    _setupEntity(entity, entity_name);
+Entity *EntityExecutor::_spawnEntity(ScriptType type, int execution_queue, int tag, Transform transform) {
+    // reuse a recycled instance if there is one, otherwise allocate one, and set it up
+    EntityAllocatorInterface *allocator = _entityinfos[type.index]._allocator;
+    Entity *entity = static_cast<Entity*>(_takeRecycled(type, tag));
+    if (!entity)
+        entity = allocator->_allocate(tag);
+    _setupScript(entity, allocator, type, execution_queue);
+    _setupEntity(entity);
     entity->transform = transform;
 
     return entity;
 }
 
+Script *EntityExecutor::_spawnRecord(const SpawnRecord &record) {
+    if (record._type.index < _entityinfos.size() && _entityinfos[record._type.index]._allocator)
+        return _spawnEntity(record._type, record._execution_queue, record._tag, _spawntransforms[record._data]);
+    return Executor::_spawnRecord(record);
+}
+
+void EntityExecutor::_clearSpawnRecords() {
+    Executor::_clearSpawnRecords();
+    _spawntransforms.clear();
+}
+
 EntityExecutor::EntityExecutor(unsigned queues, GLEnv *glenv, unordered_map_string_Animation_t *animations, PhysSpace<Box> *box_space, PhysSpace<Sphere> *sphere_space, unordered_map_string_Filter_t *filters) : Executor() { 
     init(queues, glenv, animations, box_space, sphere_space, filters);
 }
 EntityExecutor::EntityExecutor(EntityExecutor &&other) : Executor() { operator=(std::move(other)); }
-EntityExecutor::EntityExecutor() : Executor(), _glenv(nullptr), _animations(nullptr) {}
+EntityExecutor::EntityExecutor() : Executor(), _glenv(nullptr), _animations(nullptr), _box_space(nullptr), _sphere_space(nullptr), _filters(nullptr) {}
 EntityExecutor::~EntityExecutor() { /* automatic destruction is fine */ }
 
 EntityExecutor &EntityExecutor::operator=(EntityExecutor &&other) {
-    if (this == &other) {
+    if (this != &other) {
         Executor::operator=(std::move(other));
-        _entityinfos = other._entityinfos;
+        _entityinfos = std::move(other._entityinfos);
+        _spawntransforms = std::move(other._spawntransforms);
         _glenv = other._glenv;
         _animations = other._animations;
         _box_space = other._box_space;
         _sphere_space = other._sphere_space;
         _filters = other._filters;
         other._entityinfos.clear();
+        other._spawntransforms.clear();
         other._glenv = nullptr;
         other._animations = nullptr;
         other._box_space = nullptr;
@@ -98,6 +119,7 @@ void EntityExecutor::init(unsigned queues, GLEnv *glenv, unordered_map_string_An
 void EntityExecutor::uninit() {
     Executor::uninit();
     _entityinfos.clear();
+    _spawntransforms.clear();
     _glenv = nullptr;
     _animations = nullptr;
     _box_space = nullptr;
@@ -105,16 +127,28 @@ void EntityExecutor::uninit() {
     _filters = nullptr;
 }
 
-void EntityExecutor::addEntity(EntityAllocatorInterface *allocator, const char *name, int group, bool removeonkill, std::function<void(Script*)> spawn_callback, std::function<void(Script*)>  remove_callback) {
-    if (!hasAdded(name)) {
-        Executor::add(nullptr, name, group, removeonkill, spawn_callback, remove_callback);
-        _entityinfos[name] = EntityInfo{allocator};
-    } else
+ScriptType EntityExecutor::addEntity(EntityAllocatorInterface *allocator, const char *name, int group, bool removeonkill, std::function<void(Script*)> spawn_callback, std::function<void(Script*)>  remove_callback) {
+    if (hasAdded(name))
         throw std::runtime_error("Attempt to add already added name");
+
+    // types are shared with plain Scripts, which have no EntityInfo allocator
+    ScriptType type = Executor::add(nullptr, name, group, removeonkill, spawn_callback, remove_callback);
+    _entityinfos.resize(type.index + 1, EntityInfo{nullptr});
+    _entityinfos[type.index] = EntityInfo{allocator};
+    return type;
+}
+
+void EntityExecutor::enqueueSpawnEntity(ScriptType type, int execution_queue, int tag, Transform transform) {
+    _checkType(type);
+    if (type.index >= _entityinfos.size() || !_entityinfos[type.index]._allocator)
+        throw std::runtime_error("Attempt to spawn Entity with type not added as an Entity");
+
+    _spawntransforms.push_back(transform);
+    _pushSpawnRecord(SpawnRecord{type, execution_queue, tag, unsigned(_spawntransforms.size() - 1)});
 }
 
 void EntityExecutor::enqueueSpawnEntity(const char *entity_name, int execution_queue, int tag, Transform transform) {
-    _pushSpawnEnqueue(new EntityEnqueue(this, entity_name, execution_queue, tag, transform));
+    enqueueSpawnEntity(getType(entity_name), execution_queue, tag, transform);
 }
 
 GLEnv &EntityExecutor::glenv() { return *_glenv; }
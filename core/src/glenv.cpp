@@ -2,28 +2,97 @@
 
 // _______________________________________ Quad _______________________________________
 
-Quad::Quad(GLUtil::BVec3 position, GLUtil::BVec3 scale, GLUtil::BVec4 color, GLUtil::BVec3 textureposition, GLUtil::BVec2 texturesize) : 
-    _first_step(false),
-    bv_pos(position), 
-    bv_scale(scale),
-    bv_color(color),
-    bv_texpos(textureposition), 
-    bv_texsize(texturesize)
-{}
-Quad::Quad() {}
+Quad::Quad(GLEnv *glenv, unsigned offset) : _glenv(glenv), _offset(offset), _first_step(false) {}
+Quad::Quad() : _glenv(nullptr), _offset(0), _first_step(false) {}
 Quad::~Quad() { /* automatic destruction is fine */ }
 
-void Quad::update() {
-    bv_pos.update();
-    bv_scale.update();
-    bv_color.update();
-    bv_texpos.update();
-    bv_texsize.update();
+unsigned Quad::_slot() { return _glenv->_slots[_offset]; }
+
+const glm::vec3 &Quad::getPos() { return _glenv->_pos[_slot()]; }
+const glm::vec3 &Quad::getScale() { return _glenv->_scale[_slot()]; }
+const glm::vec4 &Quad::getColor() { return _glenv->_color[_slot()]; }
+const glm::vec3 &Quad::getTexPos() { return _glenv->_texpos[_slot()]; }
+const glm::vec2 &Quad::getTexSize() { return _glenv->_texsize[_slot()]; }
+
+void Quad::setPos(glm::vec3 pos) {
+    unsigned slot = _slot();
+    if (_glenv->_pos[slot] == pos)
+        return;
+    bool layer_changed = _glenv->_pos[slot].z != pos.z;
+    _glenv->_pos[slot] = pos;
+    _glenv->_setDirty(GLEnv::ATTRIB_POS, slot);
+
+    if (layer_changed && (_glenv->_flags & GLE_LAYERED))
+        _glenv->_rebucket(_offset);
+}
+
+void Quad::setScale(glm::vec3 scale) {
+    unsigned slot = _slot();
+    if (_glenv->_scale[slot] == scale)
+        return;
+    _glenv->_scale[slot] = scale;
+    _glenv->_setDirty(GLEnv::ATTRIB_SCALE, slot);
+}
+
+void Quad::setColor(glm::vec4 color) {
+    unsigned slot = _slot();
+    if (_glenv->_color[slot] == color)
+        return;
+    bool opacity_changed = (_glenv->_color[slot].w < 1.0f) != (color.w < 1.0f);
+    _glenv->_color[slot] = color;
+    _glenv->_setDirty(GLEnv::ATTRIB_COLOR, slot);
+
+    if (opacity_changed && (_glenv->_flags & GLE_LAYERED))
+        _glenv->_rebucket(_offset);
+}
+
+void Quad::setTexPos(glm::vec3 texpos) {
+    unsigned slot = _slot();
+    if (_glenv->_texpos[slot] == texpos)
+        return;
+    _glenv->_texpos[slot] = texpos;
+    _glenv->_setDirty(GLEnv::ATTRIB_TEXPOS, slot);
+}
+
+void Quad::setTexSize(glm::vec2 texsize) {
+    unsigned slot = _slot();
+    if (_glenv->_texsize[slot] == texsize)
+        return;
+    _glenv->_texsize[slot] = texsize;
+    _glenv->_setDirty(GLEnv::ATTRIB_TEXSIZE, slot);
 }
 
 void Quad::setAnim(Animation *animation) {
     _animationstate.setAnimation(animation);
     _first_step = true;
+
+    if (_glenv->_flags & GLE_GPU_ANIM) {
+        // record the Animation's cycles and the tick to play them from
+        glm::uvec4 anim(0u);
+        if (animation) {
+            auto iter = _glenv->_anim_cycles.find(animation);
+            if (iter == _glenv->_anim_cycles.end())
+                throw std::runtime_error("Attempt to set Animation not written to GLEnv");
+            anim = glm::uvec4(iter->second, 0u, _glenv->_tick, 1u);
+        }
+
+        unsigned slot = _slot();
+        _glenv->_anim[slot] = anim;
+        _glenv->_setDirty(GLEnv::ATTRIB_ANIM, slot);
+    }
+}
+
+void Quad::setCycle(unsigned cycle) {
+    _animationstate.setCycleState(cycle);
+
+    if (_glenv->_flags & GLE_GPU_ANIM) {
+        unsigned slot = _slot();
+        if (_glenv->_anim[slot].y == cycle)
+            return;
+        _glenv->_anim[slot].y = cycle;
+        _glenv->_anim[slot].z = _glenv->_tick;
+        _glenv->_setDirty(GLEnv::ATTRIB_ANIM, slot);
+    }
 }
 
 AnimationState &Quad::animationstate() {
@@ -31,7 +100,7 @@ AnimationState &Quad::animationstate() {
 }
 
 void Quad::stepAnim() {
-    if (!_animationstate.hasAnimation())
+    if (!_animationstate.hasAnimation() || (_glenv->_flags & GLE_GPU_ANIM))
         return;
     
     if (!_first_step) {
@@ -42,205 +111,895 @@ void Quad::stepAnim() {
     }
 
     // write frame data to quad
-    bv_texpos.v = _animationstate.current().texpos;
-    bv_texsize.v = _animationstate.current().texsize;
-    bv_scale.v = _animationstate.current().scale;
+    setTexPos(_animationstate.current().texpos);
+    setTexSize(_animationstate.current().texsize);
+    setScale(_animationstate.current().scale);
 }
 
+unsigned Quad::getOffset() { return _offset; }
+
 // _______________________________________ Shaders _______________________________________
 
-const char * const vert_shader_str = R"(
-    #version 460
+// prepended to shaders, followed by the defines selecting the instance layout and draw type (no 4.6 features are used, so
+// that 4.5 contexts such as Mesa's llvmpipe suffice)
+const char * const shader_version_str = "#version 450\n";
 
+// shared by both draw types; GLENV_TEXTURED reads texture attributes and passes texture coordinates, GLENV_ELLIPSE 
+// passes what ellipses are computed from instead (both with GLENV_LAYERED, which also passes the draw type of each 
+// instance), and GLENV_GPU_ANIM resolves the current frame of animated instances from animation storage
+const char * const vert_shader_str = R"(
     layout(location = 0) in vec4 v_model;
+#ifdef GLENV_PACKED
+    // fixed point position and scale, normalized color, and texture position (w unused)
+    layout(location = 1) in vec4 v_pos_packed;
+    layout(location = 2) in vec2 v_scale_packed;
+    layout(location = 3) in vec4 v_color;
+#ifdef GLENV_TEXTURED
+    layout(location = 4) in vec4 v_texpos_packed;
+    layout(location = 5) in vec2 v_texsize;
+#endif
+#else
     layout(location = 1) in vec3 v_pos;
     layout(location = 2) in vec3 v_scale;
     layout(location = 3) in vec4 v_color;
+#ifdef GLENV_TEXTURED
     layout(location = 4) in vec3 v_texpos;
     layout(location = 5) in vec2 v_texsize;
-    layout(location = 6) in float v_type;
-    layout(location = 7) in float v_draw;
+#endif
+#endif
+
+#ifdef GLENV_LAYERED
+    layout(location = 7) in uint v_type;
+#endif
 
     layout(location = 8) uniform mat4 u_view;
     layout(location = 9) uniform mat4 u_proj;
 
+#ifdef GLENV_GPU_ANIM
+    // first cycle of animation, cycle within it, starting tick, and whether animated
+    layout(location = 6) in uvec4 v_anim;
+    layout(location = 14) uniform uint u_tick;
+
+    struct AnimCycle {
+        uint first_frame;
+        uint frame_count;
+        uint duration;
+        uint loops;
+    };
+    struct AnimFrame {
+        vec4 texpos;
+        vec4 scale;
+        vec2 texsize;
+        uint duration;
+    };
+    layout(std430, binding = 0) readonly buffer AnimCycles { AnimCycle anim_cycles[]; };
+    layout(std430, binding = 1) readonly buffer AnimFrames { AnimFrame anim_frames[]; };
+#endif
+
+    out vec4 f_color;
+#ifdef GLENV_ELLIPSE
+#ifdef GLENV_OFFSCREEN
+    out vec2 f_local;
+#else
     out vec3 f_pos;
     out vec3 f_scale;
-    out vec4 f_color;
+#endif
+#endif
+#ifdef GLENV_TEXTURED
     out vec3 f_texcoords;
-    out float f_type;
-
-    vec2 halfround(vec2 v) {
-	    return floor(v) + vec2(0.5);	
-    }
+#endif
+#ifdef GLENV_LAYERED
+    flat out uint f_type;
+#endif
 
     void main() {
-        // pass position, scale, and color to fragment shader
-        f_pos = v_pos;
-        f_scale = v_scale;
+#ifdef GLENV_PACKED
+        // unpack fixed point values
+        vec3 pos = v_pos_packed.xyz / GLENV_PACKED_SUBPIXEL;
+        vec3 scale = vec3(v_scale_packed / GLENV_PACKED_SUBPIXEL, 0.0);
+#ifdef GLENV_TEXTURED
+        vec3 texpos = v_texpos_packed.xyz;
+        vec2 texsize = v_texsize;
+#endif
+#else
+        vec3 pos = v_pos;
+        vec3 scale = v_scale;
+#ifdef GLENV_TEXTURED
+        vec3 texpos = v_texpos;
+        vec2 texsize = v_texsize;
+#endif
+#endif
+
+#ifdef GLENV_GPU_ANIM
+        // find the frame the elapsed ticks fall into, holding the last one once a non looping cycle completes
+        AnimCycle cycle = anim_cycles[v_anim.x + v_anim.y];
+        if (v_anim.w != 0u && cycle.frame_count != 0u) {
+            uint elapsed = u_tick - v_anim.z;
+            if (cycle.loops != 0u && cycle.duration != 0u)
+                elapsed %= cycle.duration;
+
+            uint frame = cycle.first_frame + cycle.frame_count - 1u;
+            for (uint i = 0u; i < cycle.frame_count; i++) {
+                uint duration = anim_frames[cycle.first_frame + i].duration;
+                if (elapsed < duration) {
+                    frame = cycle.first_frame + i;
+                    break;
+                }
+                elapsed -= duration;
+            }
+
+            scale = anim_frames[frame].scale.xyz;
+#ifdef GLENV_TEXTURED
+            texpos = anim_frames[frame].texpos.xyz;
+            texsize = anim_frames[frame].texsize;
+#endif
+        }
+#endif
+
+        // pass color to fragment shader
         f_color = v_color;
 
+#ifdef GLENV_ELLIPSE
+#ifdef GLENV_OFFSCREEN
+        // pass coordinates within the quad ([0, 1], [0, 1]), interpolated at pixel centers
+        f_local = v_model.xy;
+#else
+        // pass position and scale to fragment shader
+        f_pos = pos;
+        f_scale = scale;
+#endif
+#endif
+#ifdef GLENV_TEXTURED
         // get final texture coordinates by adding: texsize multiplied by model positions (are either 0.0 or 1.0), and flip the vertical shift
         f_texcoords = 
-            v_texpos 
+            texpos 
             + 
             (
-                vec3(v_texsize, 0.0)
+                vec3(texsize, 0.0)
                 * vec3(v_model.x, 1.0 - v_model.y, 0.0)
             )
         ;
-
+#endif
+#ifdef GLENV_LAYERED
         f_type = v_type;
+#endif
         
         // get final pos by shifting unit model to center, scaling it by attribute scale, and adding attribute pos
         vec4 final_pos = 
             (
                 (
                     (v_model + vec4(-0.5f, -0.5f, 0.0f, 0.0f)) 
-                    * vec4(v_scale, 1.0f)
+                    * vec4(scale, 1.0f)
                 ) 
-                + vec4(v_pos, 0.0f)
-            ) 
-            * v_draw
+                + vec4(pos, 0.0f)
+            )
         ;
 
         gl_Position = u_proj * u_view * round(final_pos);
     }
 )";
 
+// renders as textured rectangle with GLENV_TEXTURED, or as ellipse with GLENV_ELLIPSE; when rendering ellipses at pixel 
+// space resolution, interpolated coordinates within the quad fall on pixel centers already, otherwise they are rebuilt 
+// from the fragment's window coordinates. With GLENV_LAYERED, both are defined and the draw type of the instance selects
+// one, and fully transparent fragments are discarded so that they do not occlude layers drawn after them.
 const char * const frag_shader_str = R"(
-    #version 460
-
+    in vec4 f_color;
+#ifdef GLENV_TEXTURED
     layout(location = 10) uniform sampler2DArray texsamplerarray;
     layout(location = 11) uniform uvec3 texarraydims;
+
+    in vec3 f_texcoords;
+#endif
+#ifdef GLENV_ELLIPSE
+#ifdef GLENV_OFFSCREEN
+    in vec2 f_local;
+#else
     layout(location = 12) uniform uvec2 windowspace;
     layout(location = 13) uniform uvec3 pixelspace;
 
     in vec3 f_pos;
     in vec3 f_scale;
-    in vec4 f_color;
-    in vec3 f_texcoords;
-    in float f_type;
-
-    out vec4 fragcolor;
 
     vec2 halfround(vec2 v) {
 	    return floor(v) + vec2(0.5);	
     }
+#endif
+#endif
+#ifdef GLENV_LAYERED
+    flat in uint f_type;
+#endif
 
-    void main() {
-        // render as textured rectangle
-        if (f_type == 0.0) {
-
-            // normalize "raw" texture coordinates with full texture size
-            vec4 texel = texture(texsamplerarray, f_texcoords / vec3(texarraydims.xy, 1));
+    out vec4 fragcolor;
 
-            if (texel.xyz == vec3(255.0 / 255.0, 0.0, 128.0 / 255.0))
-                discard;
-            
-            fragcolor = texel * f_color;
+#ifdef GLENV_TEXTURED
+    vec4 rectColor() {
+        // normalize "raw" texture coordinates with full texture size
+        vec4 texel = texture(texsamplerarray, f_texcoords / vec3(texarraydims.xy, 1));
 
-        // render as ellipse (ignore texture attributes)
-        } else {
+        if (texel.xyz == vec3(255.0 / 255.0, 0.0, 128.0 / 255.0))
+            discard;
         
-            vec2 windowspacef = vec2(windowspace);
-            vec2 pixelspacef2D = vec2(pixelspace.xy);
-            
-            float dist = distance(
-                // get distance from normalized quad coordinates from quad center
-                vec2(0.5),
+        return texel * f_color;
+    }
+#endif
+
+#ifdef GLENV_ELLIPSE
+    vec4 ellipseColor() {
+#ifdef GLENV_OFFSCREEN
+        float dist = distance(vec2(0.5), f_local);
+#else
+        vec2 windowspacef = vec2(windowspace);
+        vec2 pixelspacef2D = vec2(pixelspace.xy);
+        
+        float dist = distance(
+            // get distance from normalized quad coordinates from quad center
+            vec2(0.5),
+            (
+                // normalize fragment coordinates to within quad ([0, 1], [0, 1])
                 (
-                    // normalize fragment coordinates to within quad ([0, 1], [0, 1])
-                    (
-                        // fragment coordinates normalized to pixel space
-                        halfround(gl_FragCoord.xy * (pixelspacef2D / windowspacef))
-                        // minimum coordinates within quad boundaries
-                        - vec2(
-                            // pixel position shifted to origin being in bottom left
-                            (f_pos.xy + (pixelspacef2D / 2.0))
-                            - (f_scale.xy / 2.0)
-                        )
+                    // fragment coordinates normalized to pixel space
+                    halfround(gl_FragCoord.xy * (pixelspacef2D / windowspacef))
+                    // minimum coordinates within quad boundaries
+                    - vec2(
+                        // pixel position shifted to origin being in bottom left
+                        (f_pos.xy + (pixelspacef2D / 2.0))
+                        - (f_scale.xy / 2.0)
                     )
-                    / f_scale.xy
                 )
-            );
-            
-            if (dist > 0.5)
-                discard;
-            
-            fragcolor = f_color;
-        }
+                / f_scale.xy
+            )
+        );
+#endif
+        
+        if (dist > 0.5)
+            discard;
+        
+        return f_color;
+    }
+#endif
+
+    void main() {
+#ifdef GLENV_LAYERED
+        if (f_type == GLENV_TYPE_ELLIPSE)
+            fragcolor = ellipseColor();
+        else
+            fragcolor = rectColor();
+
+        if (fragcolor.a == 0.0)
+            discard;
+#elif defined(GLENV_ELLIPSE)
+        fragcolor = ellipseColor();
+#else
+        fragcolor = rectColor();
+#endif
     }
 )";
 
+// number of float components of each per instance attribute, indexed by GLEnv::Attrib (animation records and draw 
+// types are unsigned integers instead, and never packed)
+const GLint attrib_components[] = { 3, 3, 4, 3, 2, 4, 1 };
+
+/* Format of each per instance attribute with GLE_PACKED, indexed by GLEnv::Attrib. The unused w components of the
+   position and texture position keep them 4-byte aligned. */
+struct PackedFormat {
+    GLint components;
+    GLenum type;
+    bool normalized;
+    unsigned size;
+};
+const PackedFormat packed_formats[] = {
+    { 4, GL_SHORT, false, 4 * sizeof(GLshort) },
+    { 2, GL_SHORT, false, 2 * sizeof(GLshort) },
+    { 4, GL_UNSIGNED_BYTE, true, 4 * sizeof(GLubyte) },
+    { 4, GL_UNSIGNED_SHORT, false, 4 * sizeof(GLushort) },
+    { 2, GL_UNSIGNED_SHORT, false, 2 * sizeof(GLushort) },
+    { 4, GL_UNSIGNED_INT, false, 4 * sizeof(GLuint) },
+    { 1, GL_UNSIGNED_INT, false, sizeof(GLuint) }
+};
+
+// layout of animation data in shader storage (std430), matching AnimCycle and AnimFrame in the vertex shader
+struct AnimCycleData {
+    GLuint first_frame;
+    GLuint frame_count;
+    GLuint duration;
+    GLuint loops;
+};
+struct AnimFrameData {
+    GLfloat texpos[4];
+    GLfloat scale[4];
+    GLfloat texsize[2];
+    GLuint duration;
+    GLuint padding;
+};
+
+// quantization of values into packed formats, clamping them to the representable range
+GLshort packFixed(float value) {
+    return GLshort(std::round(glm::clamp(value * GLENV_PACKED_SUBPIXEL, -32768.0f, 32767.0f)));
+}
+GLushort packUnsigned(float value) {
+    return GLushort(std::round(glm::clamp(value, 0.0f, 65535.0f)));
+}
+GLubyte packNormalized(float value) {
+    return GLubyte(std::round(glm::clamp(value, 0.0f, 1.0f) * 255.0f));
+}
+
 // _______________________________________ GLEnv _______________________________________
 
-GLEnv::GLEnv(unsigned maxcount) : _initialized(false) {
-    init(maxcount);
+void GLEnv::_resize(unsigned capacity) {
+    unsigned regions = (_flags & GLE_PERSISTENT) ? GLENV_RING_SIZE : 1;
+
+    for (unsigned i = 0; i < ATTRIB_COUNT; i++) {
+        if (!_hasAttrib(i))
+            continue;
+        unsigned size = _attribSize(i);
+
+        // allocate a buffer of the new capacity in the same manner as on initialization
+        GLUtil::GLBuffer buffer;
+        if (_flags & GLE_PERSISTENT) {
+            buffer.initStorage(GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT, regions * capacity * size);
+            buffer.mapPersistent();
+        } else
+            buffer.init(GL_DYNAMIC_DRAW, capacity * size);
+
+        // copy the active slots of every region on the GPU (each region may hold different values)
+        for (unsigned r = 0; r < regions; r++)
+            buffer.copySubData(_glb_attribs[i], _count * size, r * _capacity * size, r * capacity * size);
+
+        // replace old buffer (its deletion is deferred by OpenGL until the copy is done)
+        _glb_attribs[i].uninit();
+        _glb_attribs[i] = std::move(buffer);
+        for (unsigned t = 0; t < _stageCount(); t++)
+            if (_usesAttrib(t, i))
+                _stages[t].bindBufferToIndex(_glb_attribs[i].handle(), i + 1, 0, size);
+    }
+
+    // mapped memory must not be written before the copies into it are done
+    if (_flags & GLE_PERSISTENT) {
+        GLUtil::GLFence fence;
+        fence.place();
+        fence.wait();
+    }
+
+    _pos.resize(capacity);
+    _scale.resize(capacity);
+    _color.resize(capacity);
+    _texpos.resize(capacity);
+    _texsize.resize(capacity);
+    _anim.resize(capacity);
+    _type.resize(capacity);
+    _slot_offsets.resize(capacity);
+    for (unsigned i = 0; i < ATTRIB_COUNT; i++) {
+        _dirty[i].resize(capacity, 0);
+        _dirty_end[i] = std::min(_dirty_end[i], capacity);
+    }
+
+    // release memory of slot indexed arrays when shrinking
+    if (capacity < _capacity) {
+        _pos.shrink_to_fit();
+        _scale.shrink_to_fit();
+        _color.shrink_to_fit();
+        _texpos.shrink_to_fit();
+        _texsize.shrink_to_fit();
+        _anim.shrink_to_fit();
+        _type.shrink_to_fit();
+        _slot_offsets.shrink_to_fit();
+        for (unsigned i = 0; i < ATTRIB_COUNT; i++)
+            _dirty[i].shrink_to_fit();
+    }
+
+    _capacity = capacity;
+}
+
+bool GLEnv::_usesAttrib(unsigned stage, unsigned attrib) {
+    // the layered program draws both types
+    if (_flags & GLE_LAYERED)
+        return true;
+    if (attrib == ATTRIB_TYPE)
+        return false;
+    return stage != GLE_ELLIPSE || (attrib != ATTRIB_TEXPOS && attrib != ATTRIB_TEXSIZE);
+}
+
+bool GLEnv::_hasAttrib(unsigned attrib) {
+    if (attrib == ATTRIB_ANIM)
+        return _flags & GLE_GPU_ANIM;
+    if (attrib == ATTRIB_TYPE)
+        return _flags & GLE_LAYERED;
+    return true;
+}
+
+unsigned GLEnv::_stageCount() {
+    return (_flags & GLE_LAYERED) ? 1 : GLENV_DRAWTYPE_COUNT;
+}
+
+unsigned GLEnv::_stageOf(unsigned type) {
+    return (_flags & GLE_LAYERED) ? 0 : type;
+}
+
+GLEnv::BucketKey GLEnv::_bucketKey(unsigned slot) {
+    if (!(_flags & GLE_LAYERED))
+        return BucketKey(_type[slot], 0.0f);
+
+    // translucent layers back to front after opaque layers front to back (greater z is closer to the viewer)
+    if (_color[slot].w < 1.0f)
+        return BucketKey(1, _pos[slot].z);
+    return BucketKey(0, -_pos[slot].z);
+}
+
+unsigned GLEnv::_bucketOf(unsigned slot) {
+    // last bucket beginning at or before the slot
+    return unsigned(std::upper_bound(_bucket_begin.begin(), _bucket_begin.end(), slot) - _bucket_begin.begin()) - 1;
+}
+
+unsigned GLEnv::_bucketEnd(unsigned bucket) {
+    return (bucket + 1 < _bucket_begin.size()) ? _bucket_begin[bucket + 1] : _count;
+}
+
+bool GLEnv::_rangeBoundary(unsigned slot) {
+    if (slot == 0 || slot >= _count)
+        return true;
+    return _ranges[_slot_offsets[slot - 1]] != _ranges[_slot_offsets[slot]];
+}
+
+unsigned GLEnv::_insertSlots(BucketKey key, unsigned count) {
+    // find the bucket, or add it (empty, at the slot where the following bucket begins)
+    unsigned bucket = unsigned(std::lower_bound(_bucket_keys.begin(), _bucket_keys.end(), key) - _bucket_keys.begin());
+    if (bucket == _bucket_keys.size() || _bucket_keys[bucket] != key) {
+        unsigned begin = (bucket < _bucket_begin.size()) ? _bucket_begin[bucket] : _count;
+        _bucket_keys.insert(_bucket_keys.begin() + bucket, key);
+        _bucket_begin.insert(_bucket_begin.begin() + bucket, begin);
+    }
+
+    // free the slots after the bucket, by moving the first slots of each following bucket to its end, or shifting the
+    // bucket up if they do not end with a range (the moved slots keep their order, so that ranges stay contiguous)
+    unsigned end = _count;
+    for (unsigned b = _bucket_begin.size() - 1; b > bucket; b--) {
+        unsigned begin = _bucket_begin[b];
+        if (begin + count <= end && _rangeBoundary(begin + count))
+            _moveSlots(end, begin, count);
+        else
+            _moveSlots(begin + count, begin, end - begin);
+        _bucket_begin[b] = begin + count;
+        end = begin;
+    }
+
+    _count += count;
+    _buckets_changed = true;
+    return end;
+}
+
+void GLEnv::_eraseSlots(unsigned slot, unsigned count) {
+    // fill the freed slots with the last slots of their bucket, or shift the following slots of the bucket down if the
+    // last slots do not begin with a range, then move the hole along each following bucket in the same way (the moved
+    // slots keep their order, so that ranges stay contiguous)
+    unsigned bucket = _bucketOf(slot);
+    unsigned end = _bucketEnd(bucket);
+    if (end >= slot + 2 * count && _rangeBoundary(end - count))
+        _moveSlots(slot, end - count, count);
+    else
+        _moveSlots(slot, slot + count, end - slot - count);
+    for (unsigned b = bucket + 1; b < _bucket_begin.size(); b++) {
+        unsigned begin = _bucket_begin[b];
+        end = _bucketEnd(b);
+        if (end >= begin + count && _rangeBoundary(end - count))
+            _moveSlots(begin - count, end - count, count);
+        else
+            _moveSlots(begin - count, begin, end - begin);
+        _bucket_begin[b] = begin - count;
+    }
+    _count -= count;
+
+    if (_bucketEnd(bucket) == _bucket_begin[bucket]) {
+        _bucket_keys.erase(_bucket_keys.begin() + bucket);
+        _bucket_begin.erase(_bucket_begin.begin() + bucket);
+    }
+    _buckets_changed = true;
+}
+
+void GLEnv::_rebucket(unsigned offset) {
+    unsigned slot = _slots[offset];
+    BucketKey key = _bucketKey(slot);
+    if (_bucket_keys[_bucketOf(slot)] == key)
+        return;
+
+    // take the values out of the old bucket and place them into the new one
+    glm::vec3 pos = _pos[slot];
+    glm::vec3 scale = _scale[slot];
+    glm::vec4 color = _color[slot];
+    glm::vec3 texpos = _texpos[slot];
+    glm::vec2 texsize = _texsize[slot];
+    glm::uvec4 anim = _anim[slot];
+    GLuint type = _type[slot];
+    _eraseSlots(slot, 1);
+    slot = _insertSlots(key, 1);
+
+    _slots[offset] = slot;
+    _slot_offsets[slot] = offset;
+    _pos[slot] = pos;
+    _scale[slot] = scale;
+    _color[slot] = color;
+    _texpos[slot] = texpos;
+    _texsize[slot] = texsize;
+    _anim[slot] = anim;
+    _type[slot] = type;
+    for (unsigned i = 0; i < ATTRIB_COUNT; i++)
+        _setDirty(i, slot);
+}
+
+void GLEnv::_moveSlot(unsigned dst, unsigned src) {
+    _pos[dst] = _pos[src];
+    _scale[dst] = _scale[src];
+    _color[dst] = _color[src];
+    _texpos[dst] = _texpos[src];
+    _texsize[dst] = _texsize[src];
+    _anim[dst] = _anim[src];
+    _type[dst] = _type[src];
+    for (unsigned i = 0; i < ATTRIB_COUNT; i++)
+        _setDirty(i, dst);
+
+    // remap the offset held by the source slot
+    _slots[_slot_offsets[src]] = dst;
+    _slot_offsets[dst] = _slot_offsets[src];
+}
+
+void GLEnv::_moveSlots(unsigned dst, unsigned src, unsigned count) {
+    // copy back to front when shifting up, so that overlapping slots are read before being overwritten
+    if (dst > src)
+        for (unsigned i = count; i > 0; i--)
+            _moveSlot(dst + i - 1, src + i - 1);
+    else
+        for (unsigned i = 0; i < count; i++)
+            _moveSlot(dst + i, src + i);
+}
+
+void GLEnv::_setDirty(unsigned attrib, unsigned slot) {
+    if (!_hasAttrib(attrib))
+        return;
+
+    // value must be written into every region of the buffer if persistently mapped
+    _dirty[attrib][slot] = (_flags & GLE_PERSISTENT) ? GLENV_RING_SIZE : 1;
+
+    // extend dirty range of attribute
+    if (_dirty_begin[attrib] >= _dirty_end[attrib]) {
+        _dirty_begin[attrib] = slot;
+        _dirty_end[attrib] = slot + 1;
+    } else {
+        _dirty_begin[attrib] = std::min(_dirty_begin[attrib], slot);
+        _dirty_end[attrib] = std::max(_dirty_end[attrib], slot + 1);
+    }
+}
+
+const char *GLEnv::_attribData(unsigned attrib) {
+    switch (attrib) {
+        case ATTRIB_POS: return (const char*)_pos.data();
+        case ATTRIB_SCALE: return (const char*)_scale.data();
+        case ATTRIB_COLOR: return (const char*)_color.data();
+        case ATTRIB_TEXPOS: return (const char*)_texpos.data();
+        case ATTRIB_TEXSIZE: return (const char*)_texsize.data();
+        case ATTRIB_ANIM: return (const char*)_anim.data();
+        case ATTRIB_TYPE: return (const char*)_type.data();
+        default: throw std::out_of_range("Index out of range");
+    }
+}
+
+unsigned GLEnv::_attribSize(unsigned attrib) {
+    if ((_flags & GLE_PACKED) || attrib == ATTRIB_ANIM || attrib == ATTRIB_TYPE)
+        return packed_formats[attrib].size;
+    return attrib_components[attrib] * sizeof(GLfloat);
+}
+
+void GLEnv::_writeRange(unsigned attrib, unsigned begin, unsigned end) {
+    unsigned size = _attribSize(attrib);
+    unsigned count = end - begin;
+
+    // animation records and draw types are written as is
+    if (!(_flags & GLE_PACKED) || attrib == ATTRIB_ANIM || attrib == ATTRIB_TYPE)
+        _glb_attribs[attrib].subData(count * size, _attribData(attrib) + (begin * size), begin * size);
+    else {
+        // quantize values into the staging array, then write it
+        _staging.resize(count * size);
+        for (unsigned i = 0; i < count; i++) {
+            unsigned slot = begin + i;
+            switch (attrib) {
+                case ATTRIB_POS: {
+                    GLshort *dst = (GLshort*)&_staging[i * size];
+                    dst[0] = packFixed(_pos[slot].x);
+                    dst[1] = packFixed(_pos[slot].y);
+                    dst[2] = packFixed(_pos[slot].z);
+                    dst[3] = 0;
+                    break;
+                }
+                case ATTRIB_SCALE: {
+                    GLshort *dst = (GLshort*)&_staging[i * size];
+                    dst[0] = packFixed(_scale[slot].x);
+                    dst[1] = packFixed(_scale[slot].y);
+                    break;
+                }
+                case ATTRIB_COLOR: {
+                    GLubyte *dst = (GLubyte*)&_staging[i * size];
+                    for (unsigned c = 0; c < 4; c++)
+                        dst[c] = packNormalized(_color[slot][c]);
+                    break;
+                }
+                case ATTRIB_TEXPOS: {
+                    GLushort *dst = (GLushort*)&_staging[i * size];
+                    dst[0] = packUnsigned(_texpos[slot].x);
+                    dst[1] = packUnsigned(_texpos[slot].y);
+                    dst[2] = packUnsigned(_texpos[slot].z);
+                    dst[3] = 0;
+                    break;
+                }
+                case ATTRIB_TEXSIZE: {
+                    GLushort *dst = (GLushort*)&_staging[i * size];
+                    dst[0] = packUnsigned(_texsize[slot].x);
+                    dst[1] = packUnsigned(_texsize[slot].y);
+                    break;
+                }
+            }
+        }
+        _glb_attribs[attrib].subData(count * size, _staging.data(), begin * size);
+    }
+
+    _stats.upload_bytes += count * size;
+    _stats.upload_ranges++;
+}
+
+void GLEnv::_uploadDirty(unsigned attrib) {
+    std::vector<unsigned char> &dirty = _dirty[attrib];
+    unsigned begin = _dirty_begin[attrib];
+    // slots past the active ones are not drawn, and are marked again when they become active
+    unsigned end = std::min(_dirty_end[attrib], _count);
+
+    // range of slots that remain dirty for following updates
+    unsigned next_begin = end;
+    unsigned next_end = begin;
+
+    // current range to write
+    unsigned range_begin = 0;
+    unsigned range_end = 0;
+
+    for (unsigned i = begin; i < end; i++) {
+        if (!dirty[i])
+            continue;
+
+        // extend current range if the gap to it is small enough, otherwise write it and start a new one
+        if (range_end > range_begin && i - range_end <= GLENV_COALESCE_GAP)
+            range_end = i + 1;
+        else {
+            if (range_end > range_begin)
+                _writeRange(attrib, range_begin, range_end);
+            range_begin = i;
+            range_end = i + 1;
+        }
+
+        // count down the remaining regions to write into
+        dirty[i]--;
+        if (dirty[i]) {
+            next_begin = std::min(next_begin, i);
+            next_end = std::max(next_end, i + 1);
+        }
+    }
+
+    // write last range
+    if (range_end > range_begin)
+        _writeRange(attrib, range_begin, range_end);
+
+    _dirty_begin[attrib] = next_begin;
+    _dirty_end[attrib] = next_end;
+}
+
+void GLEnv::_uploadTexture(const Image &img, GLuint xoffset, GLuint yoffset, GLuint zoffset) {
+    if (img.empty())
+        throw std::runtime_error("Attempt to upload Image with null data");
+    unsigned size = img.size();
+
+    if (size > _glb_unpack.size()) {
+        // replace the buffer with one large enough (its deletion is deferred by OpenGL until uploads from it are done)
+        _glb_unpack.uninit();
+        _glb_unpack.initStorage(GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT, std::max(size, unsigned(GLENV_UNPACK_SIZE)));
+        _glb_unpack.mapPersistent();
+        _unpack_offset = 0;
+        for (unsigned i = 0; i < GLENV_UNPACK_SEGMENTS; i++)
+            _unpack_fences[i].uninit();
+        _unpack_segment = -1;
+    } else if (_unpack_offset + size > _glb_unpack.size()) {
+        // wrap around, so that every segment is entered again
+        _unpack_offset = 0;
+        _unpack_segment = -1;
+    }
+
+    // before entering a segment, wait only for the uploads last read from it
+    unsigned segment_size = (_glb_unpack.size() + GLENV_UNPACK_SEGMENTS - 1) / GLENV_UNPACK_SEGMENTS;
+    unsigned first = _unpack_offset / segment_size;
+    unsigned last = (_unpack_offset + size - 1) / segment_size;
+    for (unsigned i = first; i <= last; i++)
+        if (int(i) != _unpack_segment)
+            _unpack_fences[i].wait();
+
+    // copy into mapped memory, and have OpenGL read the texture data from there (data pointer acts as buffer offset)
+    _glb_unpack.subData(size, img.data(), _unpack_offset);
+    _glb_unpack.bind(GL_PIXEL_UNPACK_BUFFER);
+    _texarray.subImage(0, xoffset, yoffset, zoffset, img.width(), img.height(), 1, (const void*)uintptr_t(_unpack_offset));
+    GLUtil::unbindBuffer(GL_PIXEL_UNPACK_BUFFER);
+
+    // guard the written segments until the upload is done
+    for (unsigned i = first; i <= last; i++)
+        _unpack_fences[i].place();
+    _unpack_segment = last;
+    _unpack_offset += size;
+}
+
+GLEnv::GLEnv(unsigned capacity, unsigned flags) : _unpack_offset(0), _unpack_segment(-1), _buckets_changed(false), _tick(0), _ring_index(0), _capacity(0), _flags(GLE_NONE), _initialized(false) {
+    init(capacity, flags);
 }
 
 GLEnv::GLEnv(GLEnv &&other) {
     operator=(std::move(other));
 }
 
-GLEnv::GLEnv() : _max_count(0), _initialized(false) {}
+GLEnv::GLEnv() : _unpack_offset(0), _unpack_segment(-1), _buckets_changed(false), _tick(0), _ring_index(0), _capacity(0), _min_capacity(0), _count(0), _low_updates(0), _flags(GLE_NONE), _initialized(false) {}
 GLEnv::~GLEnv() {
     uninit();
 }
 
 GLEnv& GLEnv::operator=(GLEnv &&other) {
     if (this != &other) {
-        _stage = std::move(other._stage);
+        for (unsigned t = 0; t < GLENV_DRAWTYPE_COUNT; t++)
+            _stages[t] = std::move(other._stages[t]);
         _texarray = std::move(other._texarray);
+        _atlas = other._atlas;
+        _glb_unpack = std::move(other._glb_unpack);
+        _unpack_offset = other._unpack_offset;
+        for (unsigned i = 0; i < GLENV_UNPACK_SEGMENTS; i++)
+            _unpack_fences[i] = std::move(other._unpack_fences[i]);
+        _unpack_segment = other._unpack_segment;
+        _framebuffer = std::move(other._framebuffer);
+        _windowspace = other._windowspace;
         _glb_modelbuf = std::move(other._glb_modelbuf);
         _glb_elembuf = std::move(other._glb_elembuf);
-        _glb_pos = std::move(other._glb_pos);
-        _glb_scale = std::move(other._glb_scale);
-        _glb_color = std::move(other._glb_color);
-        _glb_texpos = std::move(other._glb_texpos);
-        _glb_texsize = std::move(other._glb_texsize);
-        _glb_type = std::move(other._glb_type);
-        _glb_draw = std::move(other._glb_draw);
+        for (unsigned i = 0; i < ATTRIB_COUNT; i++)
+            _glb_attribs[i] = std::move(other._glb_attribs[i]);
+        _glb_indirect = std::move(other._glb_indirect);
+        _commands = std::move(other._commands);
+        _buckets_changed = other._buckets_changed;
+        _glb_cycles = std::move(other._glb_cycles);
+        _glb_frames = std::move(other._glb_frames);
+        _anim_cycles = std::move(other._anim_cycles);
+        _tick = other._tick;
+        for (unsigned i = 0; i < GLENV_RING_SIZE; i++)
+            _fences[i] = std::move(other._fences[i]);
+        _ring_index = other._ring_index;
+        _pos = std::move(other._pos);
+        _scale = std::move(other._scale);
+        _color = std::move(other._color);
+        _texpos = std::move(other._texpos);
+        _texsize = std::move(other._texsize);
+        _anim = std::move(other._anim);
+        _type = std::move(other._type);
+        _slots = std::move(other._slots);
+        _slot_offsets = std::move(other._slot_offsets);
+        _ranges = std::move(other._ranges);
+        _bucket_keys = std::move(other._bucket_keys);
+        _bucket_begin = std::move(other._bucket_begin);
+        for (unsigned i = 0; i < ATTRIB_COUNT; i++) {
+            _dirty[i] = std::move(other._dirty[i]);
+            _dirty_begin[i] = other._dirty_begin[i];
+            _dirty_end[i] = other._dirty_end[i];
+        }
+        _stats = other._stats;
         _quad_offsets = other._quad_offsets;
         _quads = other._quads;
-        _max_count = other._max_count;
+        // point Quads to this instance
+        for (unsigned i = 0; i < _quads.size(); i++)
+            _quads[i]._glenv = this;
+        _capacity = other._capacity;
+        _min_capacity = other._min_capacity;
         _count = other._count;
+        _low_updates = other._low_updates;
+        _flags = other._flags;
         _initialized = other._initialized;
         other._quad_offsets.clear();
         other._quads.clear();
-        other._max_count = 0;
+        other._anim_cycles.clear();
+        other._commands.clear();
+        other._buckets_changed = false;
+        other._bucket_keys.clear();
+        other._bucket_begin.clear();
+        other._tick = 0;
+        other._atlas = Atlas();
+        other._unpack_offset = 0;
+        other._unpack_segment = -1;
+        other._ring_index = 0;
+        other._capacity = 0;
+        other._min_capacity = 0;
+        other._count = 0;
+        other._low_updates = 0;
+        other._flags = GLE_NONE;
         other._initialized = false;
     }
     return *this;
 }
 
-void GLEnv::init(unsigned max_count) {
+void GLEnv::init(unsigned capacity, unsigned flags) {
     if (_initialized)
         throw InitializedException();
     
     /* initialize members */
+    // flags are needed first to determine the layout of instance buffers
+    _flags = flags;
+    _windowspace = glm::uvec2(0);
     _glb_modelbuf = GLUtil::GLBuffer(GL_STATIC_DRAW, 16 * sizeof(GLfloat));
     _glb_elembuf = GLUtil::GLBuffer(GL_STATIC_DRAW, 6 * sizeof(GLuint));
-    _glb_pos = GLUtil::GLBuffer(GL_DYNAMIC_DRAW, (max_count * 3) * sizeof(GLfloat));
-    _glb_scale = GLUtil::GLBuffer(GL_DYNAMIC_DRAW, (max_count * 3) * sizeof(GLfloat));
-    _glb_color = GLUtil::GLBuffer(GL_DYNAMIC_DRAW, (max_count * 4) * sizeof(GLfloat));
-    _glb_texpos = GLUtil::GLBuffer(GL_DYNAMIC_DRAW, (max_count * 3) * sizeof(GLfloat));
-    _glb_texsize = GLUtil::GLBuffer(GL_DYNAMIC_DRAW, (max_count * 2) * sizeof(GLfloat)); 
-    _glb_type = GLUtil::GLBuffer(GL_DYNAMIC_DRAW, (max_count * 1) * sizeof(GLfloat));
-    _glb_draw = GLUtil::GLBuffer(GL_DYNAMIC_DRAW, (max_count * 1) * sizeof(GLfloat));
-    _quads = std::vector<Quad>(max_count, Quad());
-    _max_count = max_count;
+    for (unsigned i = 0; i < ATTRIB_COUNT; i++) {
+        if (!_hasAttrib(i))
+            continue;
+        if (flags & GLE_PERSISTENT) {
+            // allocate one region per frame in flight, and keep the buffers mapped for their lifetime
+            GLbitfield storage_flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+            _glb_attribs[i].initStorage(storage_flags, GLENV_RING_SIZE * capacity * _attribSize(i));
+            _glb_attribs[i].mapPersistent();
+        } else
+            _glb_attribs[i] = GLUtil::GLBuffer(GL_DYNAMIC_DRAW, capacity * _attribSize(i));
+    }
+    _pos = std::vector<glm::vec3>(capacity, glm::vec3(0.0f));
+    _scale = std::vector<glm::vec3>(capacity, glm::vec3(0.0f));
+    _color = std::vector<glm::vec4>(capacity, glm::vec4(0.0f));
+    _texpos = std::vector<glm::vec3>(capacity, glm::vec3(0.0f));
+    _texsize = std::vector<glm::vec2>(capacity, glm::vec2(0.0f));
+    _anim = std::vector<glm::uvec4>(capacity, glm::uvec4(0u));
+    _type = std::vector<GLuint>(capacity, 0);
+    _slots.clear();
+    _ranges.clear();
+    _slot_offsets = std::vector<unsigned>(capacity, 0);
+    for (unsigned i = 0; i < ATTRIB_COUNT; i++) {
+        _dirty[i] = std::vector<unsigned char>(capacity, 0);
+        _dirty_begin[i] = 0;
+        _dirty_end[i] = 0;
+    }
+    _stats = GLEnvStats{};
+    _quads.clear();
+    _ring_index = 0;
+    _anim_cycles.clear();
+    _tick = 0;
+    if (flags & GLE_GPU_ANIM) {
+        // storage is never empty, as it is read for Quads without Animations too
+        _glb_cycles = GLUtil::GLBuffer(GL_STATIC_DRAW, sizeof(AnimCycleData));
+        _glb_frames = GLUtil::GLBuffer(GL_STATIC_DRAW, sizeof(AnimFrameData));
+    }
+    _commands.clear();
+    _buckets_changed = false;
+    _bucket_keys.clear();
+    _bucket_begin.clear();
+    _capacity = capacity;
+    _min_capacity = capacity;
     _count = 0;
+    _low_updates = 0;
 
     /* setup variables */
 
-    // store shader code and types into arrays for shader program generation call
-    const char *shaders[2];
-    shaders[0] = vert_shader_str;
-    shaders[1] = frag_shader_str;
-    GLuint types[2];
-    types[0] = GL_VERTEX_SHADER;
-    types[1] = GL_FRAGMENT_SHADER;
+    // compose shader code with the defines of the instance layout
+    std::string header = shader_version_str;
+    if (flags & GLE_PACKED)
+        header += "#define GLENV_PACKED\n#define GLENV_PACKED_SUBPIXEL " + std::to_string(GLENV_PACKED_SUBPIXEL) + ".0\n";
+    if (flags & GLE_OFFSCREEN)
+        header += "#define GLENV_OFFSCREEN\n";
+    if (flags & GLE_GPU_ANIM)
+        header += "#define GLENV_GPU_ANIM\n";
+    std::string vert_shaders[GLENV_DRAWTYPE_COUNT];
+    std::string frag_shaders[GLENV_DRAWTYPE_COUNT];
+    if (flags & GLE_LAYERED) {
+        // a single program draws both types, selected by the type of each instance
+        header += "#define GLENV_TEXTURED\n#define GLENV_ELLIPSE\n#define GLENV_LAYERED\n";
+        header += "#define GLENV_TYPE_ELLIPSE " + std::to_string(unsigned(GLE_ELLIPSE)) + "u\n";
+        vert_shaders[0] = header + vert_shader_str;
+        frag_shaders[0] = header + frag_shader_str;
+    } else {
+        vert_shaders[GLE_RECT] = header + "#define GLENV_TEXTURED\n" + vert_shader_str;
+        frag_shaders[GLE_RECT] = header + "#define GLENV_TEXTURED\n" + frag_shader_str;
+        vert_shaders[GLE_ELLIPSE] = header + "#define GLENV_ELLIPSE\n" + vert_shader_str;
+        frag_shaders[GLE_ELLIPSE] = header + "#define GLENV_ELLIPSE\n" + frag_shader_str;
+    }
+
     // prepare instance model data and elements (unit quad positioned at (0, 0) to (1, 1))
     GLfloat data_model[] = {
         0.0f, 0.0f, 0.0f, 1.0f,
@@ -252,50 +1011,41 @@ void GLEnv::init(unsigned max_count) {
         0, 1, 2, 1, 2, 3
     };
 
-    /* set up shader program */
-
-    // generate and use program
-    _stage.init(shaders, types, 2);
-
-    // set format of attributes (model vertices, position, scale, color, texture position, texture size, draw flag, texarray dimensions)
-    _stage.setAttribFormat(0, 4, GL_FLOAT, 0, 0);
-    _stage.setAttribFormat(1, 3, GL_FLOAT, 0, 1);
-    _stage.setAttribFormat(2, 3, GL_FLOAT, 0, 1);
-    _stage.setAttribFormat(3, 4, GL_FLOAT, 0, 1);
-    _stage.setAttribFormat(4, 3, GL_FLOAT, 0, 1);
-    _stage.setAttribFormat(5, 2, GL_FLOAT, 0, 1);
-    _stage.setAttribFormat(6, 1, GL_FLOAT, 0, 1);
-    _stage.setAttribFormat(7, 1, GL_FLOAT, 0, 1);
-
-    // set attribute buffer indices to 0-7
-    _stage.setAttribBufferIndex(0, 0);
-    _stage.setAttribBufferIndex(1, 1);
-    _stage.setAttribBufferIndex(2, 2);
-    _stage.setAttribBufferIndex(3, 3);
-    _stage.setAttribBufferIndex(4, 4);
-    _stage.setAttribBufferIndex(5, 5);
-    _stage.setAttribBufferIndex(6, 6);
-    _stage.setAttribBufferIndex(7, 7);
-
-    /* set up buffers */
-
     // write instance model data and elements to buffers
     _glb_modelbuf.subData(sizeof(data_model), data_model, 0 * sizeof(GLfloat));
     _glb_elembuf.subData(sizeof(data_elem), data_elem, 0 * sizeof(GLfloat));
 
-    // bind buffers to attribute buffer indices
-    _stage.bindBufferToIndex(_glb_modelbuf.handle(), 0, 0, 4 * sizeof(GLfloat));
-    _stage.bindBufferToIndex(_glb_pos.handle(), 1, 0, 3 * sizeof(GLfloat));
-    _stage.bindBufferToIndex(_glb_scale.handle(), 2, 0, 3 * sizeof(GLfloat));
-    _stage.bindBufferToIndex(_glb_color.handle(), 3, 0, 4 * sizeof(GLfloat));
-    _stage.bindBufferToIndex(_glb_texpos.handle(), 4, 0, 3 * sizeof(GLfloat));
-    _stage.bindBufferToIndex(_glb_texsize.handle(), 5, 0, 2 * sizeof(GLfloat));
-    _stage.bindBufferToIndex(_glb_type.handle(), 6, 0, 1 * sizeof(GLfloat));
-    _stage.bindBufferToIndex(_glb_draw.handle(), 7, 0, 1 * sizeof(GLfloat));
-    _stage.bindElementBuffer(_glb_elembuf.handle());
-
-    // use program
-    _stage.use();
+    /* set up one shader program per draw type, or one for both with GLE_LAYERED */
+    
+    for (unsigned t = 0; t < _stageCount(); t++) {
+        // store shader code and types into arrays for shader program generation call
+        const char *shaders[2];
+        shaders[0] = vert_shaders[t].c_str();
+        shaders[1] = frag_shaders[t].c_str();
+        GLuint types[2];
+        types[0] = GL_VERTEX_SHADER;
+        types[1] = GL_FRAGMENT_SHADER;
+        _stages[t].init(shaders, types, 2);
+
+        // set format of attributes (model vertices, then the per instance attributes read by the program at locations 
+        // 1-7), and bind buffers to their buffer indices
+        _stages[t].setAttribFormat(0, 4, GL_FLOAT, 0, 0);
+        _stages[t].setAttribBufferIndex(0, 0);
+        _stages[t].bindBufferToIndex(_glb_modelbuf.handle(), 0, 0, 4 * sizeof(GLfloat));
+        for (unsigned i = 0; i < ATTRIB_COUNT; i++) {
+            if (!_usesAttrib(t, i) || !_hasAttrib(i))
+                continue;
+            if (i == ATTRIB_ANIM || i == ATTRIB_TYPE)
+                _stages[t].setAttribIFormat(i + 1, packed_formats[i].components, packed_formats[i].type, 0, 1);
+            else if (flags & GLE_PACKED)
+                _stages[t].setAttribFormat(i + 1, packed_formats[i].components, packed_formats[i].type, packed_formats[i].normalized, 0, 1);
+            else
+                _stages[t].setAttribFormat(i + 1, attrib_components[i], GL_FLOAT, 0, 1);
+            _stages[t].setAttribBufferIndex(i + 1, i + 1);
+            _stages[t].bindBufferToIndex(_glb_attribs[i].handle(), i + 1, 0, _attribSize(i));
+        }
+        _stages[t].bindElementBuffer(_glb_elembuf.handle());
+    }
 
     // initialize texture array
     _texarray.init();
@@ -308,109 +1058,348 @@ void GLEnv::uninit() {
     if (!_initialized)
         return;
     
-    _stage.uninit();
+    for (unsigned t = 0; t < GLENV_DRAWTYPE_COUNT; t++)
+        _stages[t].uninit();
     _texarray.uninit();
+    _atlas = Atlas();
+    _glb_unpack.uninit();
+    _unpack_offset = 0;
+    for (unsigned i = 0; i < GLENV_UNPACK_SEGMENTS; i++)
+        _unpack_fences[i].uninit();
+    _unpack_segment = -1;
+    _framebuffer.uninit();
+    _windowspace = glm::uvec2(0);
     _glb_modelbuf.uninit();
     _glb_elembuf.uninit();
-    _glb_pos.uninit();
-    _glb_scale.uninit();
-    _glb_color.uninit();
-    _glb_texpos.uninit();
-    _glb_texsize.uninit();
-    _glb_draw.uninit();
+    for (unsigned i = 0; i < ATTRIB_COUNT; i++)
+        _glb_attribs[i].uninit();
+    _glb_indirect.uninit();
+    _commands.clear();
+    _buckets_changed = false;
+    _glb_cycles.uninit();
+    _glb_frames.uninit();
+    _anim_cycles.clear();
+    _tick = 0;
+    for (unsigned i = 0; i < GLENV_RING_SIZE; i++)
+        _fences[i].uninit();
+    _ring_index = 0;
+    _pos.clear();
+    _scale.clear();
+    _color.clear();
+    _texpos.clear();
+    _texsize.clear();
+    _anim.clear();
+    _type.clear();
+    _slots.clear();
+    _ranges.clear();
+    _slot_offsets.clear();
+    _bucket_keys.clear();
+    _bucket_begin.clear();
+    for (unsigned i = 0; i < ATTRIB_COUNT; i++) {
+        _dirty[i].clear();
+        _dirty_begin[i] = 0;
+        _dirty_end[i] = 0;
+    }
     _quad_offsets.clear();
     _quads.clear();
-    _max_count = 0;
+    _capacity = 0;
+    _min_capacity = 0;
+    _count = 0;
+    _low_updates = 0;
+    _flags = GLE_NONE;
     _initialized = false;
 }
 
 unsigned GLEnv::genQuad(glm::vec3 pos, glm::vec3 scale, glm::vec4 color, glm::vec3 texpos, glm::vec2 texsize, DrawType type) {
-    // if number of active offsets is greater than or equal to maximum allowed count, throw
-    if (_count >= _max_count)
-        throw CountLimitException();
+    return genQuads(1, pos, scale, color, texpos, texsize, type);
+}
 
-    // get a new unique offset
-    unsigned offset = _quad_offsets.push();
+unsigned GLEnv::genQuads(unsigned count, glm::vec3 pos, glm::vec3 scale, glm::vec4 color, glm::vec3 texpos, glm::vec2 texsize, DrawType type) {
+    if (count == 0)
+        throw std::runtime_error("Attempt to generate empty range of Quads");
+
+    // if the slots would exceed the capacity, double it until they fit
+    unsigned capacity = std::max(_capacity, 1u);
+    while (_count + count > capacity)
+        capacity *= 2;
+    if (capacity != _capacity)
+        _resize(capacity);
+
+    // free contiguous slots in the bucket the values belong in (by draw type, or with GLE_LAYERED, by opacity and layer)
+    BucketKey key(type, 0.0f);
+    if (_flags & GLE_LAYERED)
+        key = (color.w < 1.0f) ? BucketKey(1, pos.z) : BucketKey(0, -pos.z);
+    unsigned first_slot = _insertSlots(key, count);
+
+    // get a range of new unique offsets, and place them in the freed slots in order
+    unsigned first = _quad_offsets.pushRange(count);
+    while (_quads.size() < first + count) {
+        _slots.push_back(0);
+        _ranges.push_back(0);
+        _quads.push_back(Quad());
+    }
+    for (unsigned i = 0; i < count; i++) {
+        unsigned offset = first + i;
+        unsigned slot = first_slot + i;
+        _slots[offset] = slot;
+        _slot_offsets[slot] = offset;
+        _ranges[offset] = first;
     
-    // generate quad by providing the position, texture position, and texture size buffers, and
-    // specify an offset into them
-    _quads[offset] = Quad(
-        GLUtil::BVec3(&_glb_pos, offset * (3 * sizeof(GLfloat))),
-        GLUtil::BVec3(&_glb_scale, offset * (3 * sizeof(GLfloat))),
-        GLUtil::BVec4(&_glb_color, offset * (4 * sizeof(GLfloat))),
-        GLUtil::BVec3(&_glb_texpos, offset * (3 * sizeof(GLfloat))), 
-        GLUtil::BVec2(&_glb_texsize, offset * (2 * sizeof(GLfloat)))
-    );
-
-    // initialize quad with parameters
-    _quads[offset].bv_pos.v = pos;
-    _quads[offset].bv_scale.v = scale;
-    _quads[offset].bv_color.v = color;
-    _quads[offset].bv_texpos.v = texpos;
-    _quads[offset].bv_texsize.v = texsize;
-
-    // set the type and draw flags for this quad
-    GLfloat ftype = type;
-    _glb_type.subData(sizeof(GLfloat), &ftype, offset * (1 * sizeof(GLfloat)));
-    GLfloat draw = 1.0f;
-    _glb_draw.subData(sizeof(GLfloat), &draw, offset * (1 * sizeof(GLfloat)));
-
-    _count++;
-    return offset;
+        // generate quad as a view into the shadow arrays, and initialize it with parameters
+        _quads[offset] = Quad(this, offset);
+        _pos[slot] = pos;
+        _scale[slot] = scale;
+        _color[slot] = color;
+        _texpos[slot] = texpos;
+        _texsize[slot] = texsize;
+        _anim[slot] = glm::uvec4(0u);
+        _type[slot] = type;
+    }
+    for (unsigned i = 0; i < ATTRIB_COUNT; i++)
+        for (unsigned slot = first_slot; slot < first_slot + count; slot++)
+            _setDirty(i, slot);
+
+    return first;
 }
 
 void GLEnv::remove(unsigned offset) {
-    if (offset >= _quad_offsets.size())
-        throw std::out_of_range("Index out of range");
-
-    // call _quad_offsets to make the offset usable again
-    _quad_offsets.remove(offset);
+    removeQuads(offset, 1);
+}
 
-    // unset the draw flag for this specific offset, zeroing out its instance
-    GLfloat draw = 0.0f;
-    _glb_draw.subData(sizeof(GLfloat), &draw, offset * (1 * sizeof(GLfloat)));
+void GLEnv::removeQuads(unsigned first, unsigned count) {
+    if (first + count > _quad_offsets.size())
+        throw std::out_of_range("Index out of range");
 
-    _count--;
+    // call _quad_offsets to make the offsets usable again
+    _quad_offsets.removeRange(first, count);
+
+    // keep the slots of the remaining Quads densely packed, freeing the slots of the range at once if they are still
+    // contiguous and in one bucket, or one by one otherwise
+    unsigned first_slot = _slots[first];
+    bool contiguous = first_slot + count <= _bucketEnd(_bucketOf(first_slot));
+    for (unsigned i = 1; i < count && contiguous; i++)
+        contiguous = _slots[first + i] == first_slot + i;
+
+    if (contiguous)
+        _eraseSlots(first_slot, count);
+    else
+        for (unsigned i = 0; i < count; i++)
+            _eraseSlots(_slots[first + i], 1);
 }
 
 void GLEnv::setTexArray(GLuint width, GLuint height, GLuint depth) {
     _texarray.alloc(1, GL_RGBA8, GL_RGBA, GL_UNSIGNED_BYTE, width, height, depth);
-    _stage.uniform3ui(11, glm::uvec3(width, height, depth));
+    _stages[_stageOf(GLE_RECT)].uniform3ui(11, glm::uvec3(width, height, depth));
+    _atlas.reset(width, height, depth);
 }
 
-void GLEnv::setTexture(Image img, GLuint xoffset, GLuint yoffset, GLuint zoffset) {
-    unsigned char *image_data = img.copyData();
-    _texarray.subImage(0, xoffset, yoffset, zoffset, img.width(), img.height(), 1, image_data);
-    delete image_data;
+void GLEnv::setTexture(const Image &img, GLuint xoffset, GLuint yoffset, GLuint zoffset) {
+    _atlas.reserveLayer(zoffset);
+    _uploadTexture(img, xoffset, yoffset, zoffset);
+}
+
+AtlasRegion GLEnv::packTexture(const Image &img) {
+    AtlasRegion region = _atlas.pack(img.width(), img.height());
+    _uploadTexture(img, region.texpos.x, region.texpos.y, region.texpos.z);
+    return region;
 }
 
 void GLEnv::setView(glm::mat4 view) {
-    _stage.uniformmat4f(8, view);
+    for (unsigned t = 0; t < _stageCount(); t++)
+        _stages[t].uniformmat4f(8, view);
 }
 
 void GLEnv::setProj(glm::mat4 proj) {
-    _stage.uniformmat4f(9, proj);
+    for (unsigned t = 0; t < _stageCount(); t++)
+        _stages[t].uniformmat4f(9, proj);
 }
 
 void GLEnv::setWindowSpace(GLuint width, GLuint height) {
-    _stage.uniform2ui(12, glm::uvec2(width, height));
+    _windowspace = glm::uvec2(width, height);
+    if (!(_flags & GLE_OFFSCREEN))
+        _stages[_stageOf(GLE_ELLIPSE)].uniform2ui(12, glm::uvec2(width, height));
 }
 
 void GLEnv::setPixelSpace(GLuint width, GLuint height, GLuint depth) {
-    _stage.uniform3ui(13, glm::uvec3(width, height, depth));
+    // render target matches pixel space, so ellipses need no pixel space uniforms
+    if (_flags & GLE_OFFSCREEN) {
+        if (_framebuffer.width() == width && _framebuffer.height() == height)
+            return;
+        _framebuffer.uninit();
+        _framebuffer.init(width, height);
+    } else
+        _stages[_stageOf(GLE_ELLIPSE)].uniform3ui(13, glm::uvec3(width, height, depth));
+}
+
+void GLEnv::setAnimations(std::unordered_map<std::string, Animation> &animations) {
+    if (!(_flags & GLE_GPU_ANIM))
+        throw std::runtime_error("Attempt to set Animations of GLEnv without GLE_GPU_ANIM");
+
+    // flatten cycles and frames of every Animation, recording where each Animation's cycles begin
+    std::vector<AnimCycleData> cycles;
+    std::vector<AnimFrameData> frames;
+    _anim_cycles.clear();
+    for (auto &pair : animations) {
+        Animation &animation = pair.second;
+        _anim_cycles[&animation] = cycles.size();
+
+        for (unsigned c = 0; c < animation.count(); c++) {
+            Cycle &cycle = animation.cycle(c);
+            AnimCycleData cycle_data = { GLuint(frames.size()), cycle.count(), 0, cycle.loops() };
+
+            for (unsigned f = 0; f < cycle.count(); f++) {
+                const Frame &frame = cycle.frame(f);
+                frames.push_back(AnimFrameData{
+                    { frame.texpos.x, frame.texpos.y, frame.texpos.z, 0.0f },
+                    { frame.scale.x, frame.scale.y, frame.scale.z, 0.0f },
+                    { frame.texsize.x, frame.texsize.y },
+                    frame.duration,
+                    0
+                });
+                cycle_data.duration += frame.duration;
+            }
+            cycles.push_back(cycle_data);
+        }
+    }
+    if (cycles.empty())
+        cycles.push_back(AnimCycleData{});
+    if (frames.empty())
+        frames.push_back(AnimFrameData{});
+
+    // replace storage
+    _glb_cycles.uninit();
+    _glb_cycles.init(GL_STATIC_DRAW, cycles.size() * sizeof(AnimCycleData));
+    _glb_cycles.subData(cycles.size() * sizeof(AnimCycleData), cycles.data(), 0);
+    _glb_frames.uninit();
+    _glb_frames.init(GL_STATIC_DRAW, frames.size() * sizeof(AnimFrameData));
+    _glb_frames.subData(frames.size() * sizeof(AnimFrameData), frames.data(), 0);
+}
+
+void GLEnv::stepAnims() {
+    if (!(_flags & GLE_GPU_ANIM))
+        return;
+
+    _tick++;
+    for (unsigned t = 0; t < _stageCount(); t++)
+        _stages[t].uniform1ui(14, _tick);
 }
 
 void GLEnv::update() {
-    for (unsigned i = 0; i < _quad_offsets.size(); i++)
-        // only try calling update on index i if it is an active offset in _quad_offsets
-        if (_quad_offsets[i])
-            _quads[i].update();
+    if (_flags & GLE_SHRINK) {
+        // halve the capacity once usage has been low for long enough
+        if (_capacity > _min_capacity && _count <= _capacity / 4) {
+            _low_updates++;
+            if (_low_updates >= GLENV_SHRINK_UPDATES) {
+                _resize(std::max(_capacity / 2, _min_capacity));
+                _low_updates = 0;
+            }
+        } else
+            _low_updates = 0;
+    }
+
+    if (_flags & GLE_PERSISTENT) {
+        // advance to the next region, and wait until the GPU is done drawing from it
+        _ring_index = (_ring_index + 1) % GLENV_RING_SIZE;
+        _fences[_ring_index].wait();
+
+        // direct Quad writes into the region
+        for (unsigned i = 0; i < ATTRIB_COUNT; i++)
+            if (_hasAttrib(i))
+                _glb_attribs[i].setMapOffset(_ring_index * _capacity * _attribSize(i));
+    }
+
+    // write changed values of every shadow array
+    _stats = GLEnvStats{};
+    for (unsigned i = 0; i < ATTRIB_COUNT; i++)
+        if (_hasAttrib(i))
+            _uploadDirty(i);
+}
+
+void GLEnv::_bindRegion(unsigned stage) {
+    // source attributes from the region written by the last update
+    for (unsigned i = 0; i < ATTRIB_COUNT; i++)
+        if (_usesAttrib(stage, i) && _hasAttrib(i))
+            _stages[stage].bindBufferToIndex(_glb_attribs[i].handle(), i + 1, _ring_index * _capacity * _attribSize(i), _attribSize(i));
+}
+
+void GLEnv::_drawLayered() {
+    if (_bucket_keys.empty())
+        return;
+
+    // rewrite the draw commands if buckets were added, removed, or resized
+    if (_buckets_changed) {
+        _commands.clear();
+        for (unsigned b = 0; b < _bucket_keys.size(); b++)
+            _commands.push_back(GLUtil::GLDrawCommand{ 6, _bucketEnd(b) - _bucket_begin[b], 0, 0, _bucket_begin[b] });
+
+        unsigned size = _commands.size() * sizeof(GLUtil::GLDrawCommand);
+        if (size > _glb_indirect.size()) {
+            _glb_indirect.uninit();
+            _glb_indirect.init(GL_DYNAMIC_DRAW, std::max(size, 2 * _glb_indirect.size()));
+        }
+        _glb_indirect.subData(size, _commands.data(), 0);
+        _buckets_changed = false;
+    }
+
+    // bind program and texture array, in case others were bound since
+    _stages[0].use();
+    _texarray.bind(GL_TEXTURE_2D_ARRAY);
+    if (_flags & GLE_PERSISTENT)
+        _bindRegion(0);
+
+    // draw every bucket in order with one call (translucent buckets last, blended over what is behind them)
+    GLUtil::setBlending(true);
+    _glb_indirect.bind(GL_DRAW_INDIRECT_BUFFER);
+    GLUtil::renderMultiIndirect(GL_TRIANGLES, _commands.size());
+    GLUtil::setBlending(false);
 }
 
 void GLEnv::drawQuads() {
-    // draw a number of instances equal to the number of offsets in system, active or not, using the vertices in the element buffer
-    // (Instances with inactive offets will be zeroed out per the draw flag)
-    GLUtil::renderInst(GL_TRIANGLES, 6, _quad_offsets.size(), true);
+    if (_flags & GLE_OFFSCREEN) {
+        if (!_framebuffer.width())
+            throw std::runtime_error("Attempt to draw offscreen GLEnv without pixel space");
+        _framebuffer.bind();
+        _framebuffer.clear();
+    }
+
+    // bind animation storage, in case other storage was bound since
+    if (_flags & GLE_GPU_ANIM) {
+        _glb_cycles.bindBase(GL_SHADER_STORAGE_BUFFER, 0);
+        _glb_frames.bindBase(GL_SHADER_STORAGE_BUFFER, 1);
+    }
+
+    if (_flags & GLE_LAYERED)
+        _drawLayered();
+    else {
+        // draw each draw type's bucket with its own program
+        for (unsigned b = 0; b < _bucket_keys.size(); b++) {
+            unsigned t = _bucket_keys[b].first;
+            unsigned begin = _bucket_begin[b];
+            unsigned end = _bucketEnd(b);
+
+            // bind program (and texture array), in case other programs were used since
+            _stages[t].use();
+            if (t == GLE_RECT)
+                _texarray.bind(GL_TEXTURE_2D_ARRAY);
+            if (_flags & GLE_PERSISTENT)
+                _bindRegion(t);
+
+            // draw a number of instances equal to the number of active Quads of the type, starting at the first slot of its 
+            // bucket, using the vertices in the element buffer
+            GLUtil::renderInstBase(GL_TRIANGLES, 6, end - begin, begin, true);
+        }
+    }
+
+    // upscale offscreen render to the window
+    if (_flags & GLE_OFFSCREEN) {
+        GLUtil::bindDefaultFramebuffer();
+        GLUtil::setViewport(0, 0, _windowspace.x, _windowspace.y);
+        _framebuffer.blitToDefault(_windowspace.x, _windowspace.y);
+    }
+
+    // mark the region as in use until the GPU has finished these draws
+    if (_flags & GLE_PERSISTENT)
+        _fences[_ring_index].place();
 }
 
 Quad *GLEnv::getQuad(unsigned offset) {
@@ -427,4 +1416,10 @@ std::vector<unsigned> GLEnv::getOffsets() { return _quad_offsets.getUsed(); }
 
 bool GLEnv::hasOffset(unsigned offset) { return _quad_offsets.at(offset); }
 
-bool GLEnv::getInitialized() { return _initialized; }
\ No newline at end of file
+GLUtil::GLTexture2DArray &GLEnv::getTexArray() { return _texarray; }
+
+unsigned GLEnv::getCapacity() { return _capacity; }
+
+bool GLEnv::getInitialized() { return _initialized; }
+
+GLEnvStats GLEnv::getStats() { return _stats; }
\ No newline at end of file
@@ -19,6 +19,189 @@ namespace GLUtil {
 
     GLErrorException::GLErrorException() : std::runtime_error("OpenGL error") {}
 
+    GLBudgetException::GLBudgetException(const std::string &msg) : std::runtime_error(msg) {}
+
+    // backend commands are sent to, and log they are recorded into
+    GLBackend backend = GLU_OPENGL;
+    GLCommandLog command_log;
+
+    // last handle given to an object created under the null backend
+    GLuint null_handle = 0;
+
+    // records a command if the backend logs commands
+    inline void record(GLCommandType type, GLuint handle, GLsizeiptr bytes, GLuint count) {
+        if (backend != GLU_OPENGL)
+            command_log.record(type, handle, bytes, count);
+    }
+
+    // returns whether commands are sent to the OpenGL driver
+    inline bool driver() {
+        return backend != GLU_NULL;
+    }
+
+    // value of a cached binding that is unknown, so that the next bind is issued
+    const GLuint UNKNOWN_BINDING = 0xffffffff;
+
+    // shadow of the context's bindings and viewport, to skip calls that would not change them
+    GLuint bound_program = UNKNOWN_BINDING;
+    GLuint bound_vao = UNKNOWN_BINDING;
+    GLuint bound_framebuffer = UNKNOWN_BINDING;
+    GLint bound_viewport[4] = { -1, -1, -1, -1 };
+    // whether blending is enabled (UNKNOWN_BINDING if unknown)
+    GLuint blending = UNKNOWN_BINDING;
+    // buffer bindings, keyed by target and index (GENERIC_INDEX for the target's generic binding)
+    const GLuint GENERIC_INDEX = 0xffffffff;
+    std::unordered_map<uint64_t, GLuint> bound_buffers;
+    // texture bindings of the active texture unit, keyed by target
+    std::unordered_map<GLenum, GLuint> bound_textures;
+
+    // number of buffers deleted, cached with vertex buffer bindings since deleted buffer names can be reused while 
+    // vertex arrays still reference the deleted buffer
+    unsigned deleted_buffers = 0;
+
+    GLStateStats state_stats;
+
+    // returns whether a cached binding differs from the value, storing the value if so, and counts the call
+    inline bool changes(GLuint &binding, GLuint value) {
+        if (binding == value) {
+            state_stats.skipped++;
+            return false;
+        }
+        binding = value;
+        state_stats.issued++;
+        return true;
+    }
+
+    // same as above, for values of any size cached by index
+    bool changes(std::vector<std::vector<char>> &values, GLuint index, const void *value, size_t size) {
+        if (index >= values.size())
+            values.resize(index + 1);
+        std::vector<char> &cached = values[index];
+        if (cached.size() == size && std::memcmp(cached.data(), value, size) == 0) {
+            state_stats.skipped++;
+            return false;
+        }
+        cached.assign((const char*)value, (const char*)value + size);
+        state_stats.issued++;
+        return true;
+    }
+
+    // returns the cached binding of a buffer target and index (GENERIC_INDEX for the target's generic binding), 
+    // unknown if not cached yet
+    GLuint &boundBuffer(GLenum target, GLuint index) {
+        return bound_buffers.emplace((uint64_t(target) << 32) | index, UNKNOWN_BINDING).first->second;
+    }
+
+    // forgets the bindings of a deleted object, as deleting a bound object resets its bindings
+    template<typename K>
+    void forgetBindings(std::unordered_map<K, GLuint> &bindings, GLuint handle) {
+        for (auto it = bindings.begin(); it != bindings.end();) {
+            if (it->second == handle)
+                it = bindings.erase(it);
+            else
+                it++;
+        }
+    }
+
+    // returns the size of a pixel of texture data with the provided format and type, in bytes
+    GLsizeiptr pixelBytes(GLenum format, GLenum type) {
+        GLsizeiptr components = 4;
+        if (format == GL_RED)
+            components = 1;
+        else if (format == GL_RG)
+            components = 2;
+        else if (format == GL_RGB || format == GL_BGR)
+            components = 3;
+
+        if (type == GL_UNSIGNED_BYTE || type == GL_BYTE)
+            return components;
+        if (type == GL_UNSIGNED_SHORT || type == GL_SHORT || type == GL_HALF_FLOAT)
+            return components * 2;
+        return components * 4;
+    }
+
+    // framebuffer standing in for the window's framebuffer (0 for the window's framebuffer)
+    GLuint default_framebuffer = 0;
+
+    // directory to cache program binaries in (caching disabled if empty)
+    std::string program_cache_dir;
+
+    // FNV-1a hash of a byte sequence, continuing from the provided hash
+    uint64_t fnv1a(const void *data, size_t size, uint64_t hash) {
+        const unsigned char *bytes = (const unsigned char*)data;
+        for (size_t i = 0; i < size; i++) {
+            hash ^= bytes[i];
+            hash *= 0x100000001b3ull;
+        }
+        return hash;
+    }
+
+    // returns the cache file path of a program, keyed by its shaders and the driver
+    std::string programCachePath(const char *shader_srcs[], GLenum shader_types[], int count) {
+        uint64_t hash = 0xcbf29ce484222325ull;
+        for (int i = 0; i < count; i++) {
+            hash = fnv1a(&shader_types[i], sizeof(GLenum), hash);
+            hash = fnv1a(shader_srcs[i], std::strlen(shader_srcs[i]), hash);
+        }
+        GLenum names[] = { GL_VENDOR, GL_RENDERER, GL_VERSION };
+        for (GLenum name : names) {
+            const char *str = (const char*)glGetString(name);
+            if (str)
+                hash = fnv1a(str, std::strlen(str), hash);
+        }
+
+        char filename[32];
+        std::snprintf(filename, sizeof(filename), "%016llx.bin", (unsigned long long)hash);
+        return (std::filesystem::path(program_cache_dir) / filename).string();
+    }
+
+    // _______________________________________ GLCommandLog _______________________________________
+
+    GLCommandLog::GLCommandLog() : _keep(false) {
+        clear();
+    }
+
+    void GLCommandLog::record(GLCommandType type, GLuint handle, GLsizeiptr bytes, GLuint count) {
+        _counts[type]++;
+        _bytes[type] += bytes;
+        if (_keep)
+            _commands.push_back(GLCommand{type, handle, bytes, count});
+    }
+
+    void GLCommandLog::clear() {
+        _commands.clear();
+        for (unsigned i = 0; i < GLC_TYPES; i++) {
+            _counts[i] = 0;
+            _bytes[i] = 0;
+        }
+    }
+
+    void GLCommandLog::setKeepCommands(bool keep) {
+        _keep = keep;
+    }
+
+    unsigned GLCommandLog::count(GLCommandType type) { return _counts[type]; }
+    GLsizeiptr GLCommandLog::bytes(GLCommandType type) { return _bytes[type]; }
+    const std::vector<GLCommand> &GLCommandLog::commands() { return _commands; }
+
+    // names of the command types, in order
+    const char *command_names[GLC_TYPES] = {
+        "create", "delete", "upload", "write", "copy", "bind", "uniform", "state", "sync", "draw"
+    };
+
+    void GLCommandLog::budget(GLCommandType type, unsigned max) {
+        if (_counts[type] > max)
+            throw GLBudgetException(
+                std::string("Command budget exceeded: ") + std::to_string(_counts[type]) + " " + command_names[type] 
+                + " commands recorded, at most " + std::to_string(max) + " allowed"
+            );
+    }
+
+    void GLCommandLog::print(std::ostream &out) {
+        for (unsigned i = 0; i < GLC_TYPES; i++)
+            out << command_names[i] << ": " << _counts[i] << " (" << _bytes[i] << " bytes)" << std::endl;
+    }
+
     // _______________________________________ GLStage _______________________________________
 
     GLStage::GLStage(const char *shader_srcs[], GLenum shader_types[], int count) : _program_h(-1), _vao_h(-1) {
@@ -26,18 +209,71 @@ namespace GLUtil {
     }
     GLStage::GLStage() : _program_h(-1), _vao_h(-1) {}
 
-    GLStage::GLStage(GLStage &&other) {
+    GLStage::GLStage(GLStage &&other) : _program_h(-1), _vao_h(-1) {
         operator=(std::move(other));
     }
 
     GLStage& GLStage::operator=(GLStage &&other) {
         if (this != &other) {
             _program_h = other._program_h;
+            _vao_h = other._vao_h;
+            _uniforms = std::move(other._uniforms);
+            _vertex_buffers = std::move(other._vertex_buffers);
             other._program_h = -1;
+            other._vao_h = -1;
+            other._uniforms.clear();
+            other._vertex_buffers.clear();
         }
         return *this;
     }
 
+    bool GLStage::_loadBinary(const std::string &path) {
+        std::ifstream file(path, std::ios::binary);
+        if (!file)
+            return false;
+
+        // file holds the binary format followed by the binary
+        GLenum format = 0;
+        file.read((char*)&format, sizeof(GLenum));
+        if (!file)
+            return false;
+        std::vector<char> binary((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+        if (binary.empty())
+            return false;
+
+        GLuint program_h = glCreateProgram();
+        glProgramBinary(program_h, format, binary.data(), binary.size());
+
+        // drivers reject binaries they can no longer use (e.g. after an update)
+        GLint success = 0;
+        glGetProgramiv(program_h, GL_LINK_STATUS, &success);
+        if (success == GL_FALSE) {
+            glDeleteProgram(program_h);
+            return false;
+        }
+
+        _program_h = program_h;
+        return true;
+    }
+
+    void GLStage::_saveBinary(const std::string &path) {
+        GLint length = 0;
+        glGetProgramiv(_program_h, GL_PROGRAM_BINARY_LENGTH, &length);
+        if (length <= 0)
+            return;
+
+        GLenum format = 0;
+        std::vector<char> binary(length);
+        glGetProgramBinary(_program_h, length, nullptr, &format, binary.data());
+
+        // failing to store the binary only costs a compile on the next launch
+        std::ofstream file(path, std::ios::binary);
+        if (!file)
+            return;
+        file.write((const char*)&format, sizeof(GLenum));
+        file.write(binary.data(), binary.size());
+    }
+
     GLStage::~GLStage() {
         uninit();
     };
@@ -45,7 +281,32 @@ namespace GLUtil {
     void GLStage::init(const char *shader_srcs[], GLenum shader_types[], int count) {
         if (_program_h != -1 || _vao_h != -1)
             throw InitializedException();
-        
+
+        if (!driver()) {
+            _program_h = ++null_handle;
+            _vao_h = ++null_handle;
+            record(GLC_CREATE, _program_h, 0, 0);
+            return;
+        }
+
+        // load a cached program binary if available
+        std::string cache_path;
+        if (!program_cache_dir.empty())
+            cache_path = programCachePath(shader_srcs, shader_types, count);
+        if (cache_path.empty() || !_loadBinary(cache_path)) {
+            _compile(shader_srcs, shader_types, count);
+            if (!cache_path.empty())
+                _saveBinary(cache_path);
+        }
+
+        // create VAO
+        unsigned vao_h;
+        glCreateVertexArrays(1, &vao_h);
+        _vao_h = vao_h;
+        record(GLC_CREATE, _program_h, 0, 0);
+    }
+
+    void GLStage::_compile(const char *shader_srcs[], GLenum shader_types[], int count) {
         // create shaders
         GLint success = 0;
         GLuint *shaders = new GLuint[count];
@@ -73,6 +334,8 @@ namespace GLUtil {
         _program_h = glCreateProgram();
         for (int i = 0; i < count; i++)
             glAttachShader(_program_h, shaders[i]);
+        if (!program_cache_dir.empty())
+            glProgramParameteri(_program_h, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
 
         // link program
         glLinkProgram(_program_h);
@@ -96,75 +359,149 @@ namespace GLUtil {
             glDeleteShader(shaders[i]);
         }
         delete[] shaders;
-
-        // create VAO
-        unsigned vao_h;
-        glCreateVertexArrays(1, &vao_h);
-        _vao_h = vao_h;
     }
 
     void GLStage::uninit() {
-        if (_program_h != -1)
-            glDeleteProgram(_program_h);
+        if (_program_h != -1) {
+            record(GLC_DELETE, _program_h, 0, 0);
+            if (driver())
+                glDeleteProgram(_program_h);
+            // a deleted program stays in use until another is used, but its name can be reused
+            if (bound_program == GLuint(_program_h))
+                bound_program = UNKNOWN_BINDING;
+        }
 
         if (_vao_h != -1) {
             unsigned vao_h = _vao_h;
-            glDeleteVertexArrays(1, &vao_h);
+            if (driver())
+                glDeleteVertexArrays(1, &vao_h);
+            if (bound_vao == vao_h)
+                bound_vao = UNKNOWN_BINDING;
         }
 
         _program_h = -1;
         _vao_h = -1;
+        _uniforms.clear();
+        _vertex_buffers.clear();
     }
 
     void GLStage::setAttribFormat(GLuint index, GLint size, GLenum type, GLuint byte_offset, GLuint divisor) {
-        glVertexArrayAttribFormat(_vao_h, index, size, type, false, byte_offset);
-        glEnableVertexArrayAttrib(_vao_h, index);
-        glVertexArrayBindingDivisor(_vao_h, index, divisor);
+        setAttribFormat(index, size, type, false, byte_offset, divisor);
+    }
+
+    void GLStage::setAttribFormat(GLuint index, GLint size, GLenum type, bool normalized, GLuint byte_offset, GLuint divisor) {
+        record(GLC_STATE, _vao_h, 0, 0);
+        if (driver()) {
+            glVertexArrayAttribFormat(_vao_h, index, size, type, normalized, byte_offset);
+            glEnableVertexArrayAttrib(_vao_h, index);
+            glVertexArrayBindingDivisor(_vao_h, index, divisor);
+        }
+    }
+
+    void GLStage::setAttribIFormat(GLuint index, GLint size, GLenum type, GLuint byte_offset, GLuint divisor) {
+        record(GLC_STATE, _vao_h, 0, 0);
+        if (driver()) {
+            glVertexArrayAttribIFormat(_vao_h, index, size, type, byte_offset);
+            glEnableVertexArrayAttrib(_vao_h, index);
+            glVertexArrayBindingDivisor(_vao_h, index, divisor);
+        }
     }
 
     void GLStage::setAttribBufferIndex(GLuint attrib_index, GLuint binding_index) {
-        glVertexArrayAttribBinding(_vao_h, attrib_index, binding_index);
+        record(GLC_STATE, _vao_h, 0, 0);
+        if (driver())
+            glVertexArrayAttribBinding(_vao_h, attrib_index, binding_index);
     }
 
     void GLStage::bindBufferToIndex(GLuint buffer_handle, GLuint index, GLintptr offset, GLsizei stride) {
-        glVertexArrayVertexBuffer(_vao_h, index, buffer_handle, offset, stride);
+        GLintptr binding[4] = { GLintptr(buffer_handle), GLintptr(deleted_buffers), offset, GLintptr(stride) };
+        if (!changes(_vertex_buffers, index, &binding, sizeof(binding)))
+            return;
+
+        record(GLC_BIND, buffer_handle, 0, 0);
+        if (driver())
+            glVertexArrayVertexBuffer(_vao_h, index, buffer_handle, offset, stride);
     }
 
     void GLStage::bindElementBuffer(GLuint buffer_handle) {
-        glVertexArrayElementBuffer(_vao_h, buffer_handle);
+        record(GLC_BIND, buffer_handle, 0, 0);
+        if (driver())
+            glVertexArrayElementBuffer(_vao_h, buffer_handle);
     }
 
     void GLStage::uniform1i(GLuint index, GLint value) {
-        glProgramUniform1i(_program_h, index, value);
+        if (!changes(_uniforms, index, &value, sizeof(value)))
+            return;
+
+        record(GLC_UNIFORM, _program_h, sizeof(value), 0);
+        if (driver())
+            glProgramUniform1i(_program_h, index, value);
     }
 
     void GLStage::uniform1f(GLuint index, GLfloat value) {
-        glProgramUniform1f(_program_h, index, value);
+        if (!changes(_uniforms, index, &value, sizeof(value)))
+            return;
+
+        record(GLC_UNIFORM, _program_h, sizeof(value), 0);
+        if (driver())
+            glProgramUniform1f(_program_h, index, value);
+    }
+
+    void GLStage::uniform1ui(GLuint index, GLuint value) {
+        if (!changes(_uniforms, index, &value, sizeof(value)))
+            return;
+
+        record(GLC_UNIFORM, _program_h, sizeof(value), 0);
+        if (driver())
+            glProgramUniform1ui(_program_h, index, value);
     }
 
     void GLStage::uniformmat4f(GLuint index, glm::mat4 value) {
-        glProgramUniformMatrix4fv(_program_h, index, 1, false, glm::value_ptr(value));
+        if (!changes(_uniforms, index, glm::value_ptr(value), sizeof(value)))
+            return;
+
+        record(GLC_UNIFORM, _program_h, sizeof(value), 0);
+        if (driver())
+            glProgramUniformMatrix4fv(_program_h, index, 1, false, glm::value_ptr(value));
     }
 
     void GLStage::uniform2ui(GLuint index, glm::uvec2 value) {
-        glProgramUniform2ui(_program_h, index, value.x, value.y);
+        if (!changes(_uniforms, index, glm::value_ptr(value), sizeof(value)))
+            return;
+
+        record(GLC_UNIFORM, _program_h, sizeof(value), 0);
+        if (driver())
+            glProgramUniform2ui(_program_h, index, value.x, value.y);
     }
 
     void GLStage::uniform3ui(GLuint index, glm::uvec3 value) {
-        glProgramUniform3ui(_program_h, index, value.x, value.y, value.z);
+        if (!changes(_uniforms, index, glm::value_ptr(value), sizeof(value)))
+            return;
+
+        record(GLC_UNIFORM, _program_h, sizeof(value), 0);
+        if (driver())
+            glProgramUniform3ui(_program_h, index, value.x, value.y, value.z);
     }
 
     void GLStage::use() {
-        glBindVertexArray(_vao_h);
-        glUseProgram(_program_h); 
+        if (changes(bound_vao, _vao_h)) {
+            record(GLC_BIND, _vao_h, 0, 0);
+            if (driver())
+                glBindVertexArray(_vao_h);
+        }
+        if (changes(bound_program, _program_h)) {
+            record(GLC_BIND, _program_h, 0, 0);
+            if (driver())
+                glUseProgram(_program_h); 
+        }
     }
 
     // _______________________________________ GLBuffer _______________________________________
 
-    GLBuffer::GLBuffer(GLenum buffer_usage, GLuint buffer_size) : _buf_h(-1), _usage(0), _size(0) {
+    GLBuffer::GLBuffer(GLenum buffer_usage, GLuint buffer_size) : _buf_h(-1), _usage(0), _size(0), _storage_flags(0), _mapped(nullptr), _map_offset(0), _host(nullptr) {
         init(buffer_usage, buffer_size);
     }
-    GLBuffer::GLBuffer() : _buf_h(-1), _usage(0), _size(0) {}
+    GLBuffer::GLBuffer() : _buf_h(-1), _usage(0), _size(0), _storage_flags(0), _mapped(nullptr), _map_offset(0), _host(nullptr) {}
 
     GLBuffer::GLBuffer(GLBuffer &&other) {
         operator=(std::move(other));
@@ -175,9 +512,17 @@ namespace GLUtil {
             _buf_h = other._buf_h;
             _usage = other._usage;
             _size = other._size;
+            _storage_flags = other._storage_flags;
+            _mapped = other._mapped;
+            _map_offset = other._map_offset;
+            _host = other._host;
             other._buf_h = -1;
             other._usage = 0;
             other._size = 0;
+            other._storage_flags = 0;
+            other._mapped = nullptr;
+            other._map_offset = 0;
+            other._host = nullptr;
         }
         return *this;
     }
@@ -193,45 +538,147 @@ namespace GLUtil {
         // create empty data space
         GLuint buf_h = _buf_h;
 
-        glCreateBuffers(1, &buf_h);
-        glNamedBufferData(buf_h, buffer_size, NULL, buffer_usage);
+        if (driver()) {
+            glCreateBuffers(1, &buf_h);
+            glNamedBufferData(buf_h, buffer_size, NULL, buffer_usage);
+        } else {
+            buf_h = ++null_handle;
+            _host = new char[buffer_size]();
+        }
+        record(GLC_CREATE, buf_h, buffer_size, 0);
 
         _buf_h = buf_h;
         _usage = buffer_usage;
         _size = buffer_size;
     }
 
+    void GLBuffer::initStorage(GLbitfield storage_flags, GLuint buffer_size) {
+        if (_buf_h != -1)
+            throw InitializedException();
+        
+        // create immutable data space
+        GLuint buf_h = _buf_h;
+
+        if (driver()) {
+            glCreateBuffers(1, &buf_h);
+            glNamedBufferStorage(buf_h, buffer_size, NULL, storage_flags);
+        } else {
+            buf_h = ++null_handle;
+            _host = new char[buffer_size]();
+        }
+        record(GLC_CREATE, buf_h, buffer_size, 0);
+
+        _buf_h = buf_h;
+        _size = buffer_size;
+        _storage_flags = storage_flags;
+    }
+
     void GLBuffer::uninit() {
         if (_buf_h != -1) {
             GLuint buf_h = _buf_h;
-            glDeleteBuffers(1, &buf_h);
+            record(GLC_DELETE, buf_h, 0, 0);
+            if (!_host) {
+                if (_mapped)
+                    glUnmapNamedBuffer(buf_h);
+                glDeleteBuffers(1, &buf_h);
+            }
+            forgetBindings(bound_buffers, buf_h);
+            deleted_buffers++;
         }
+        delete[] _host;
 
         _buf_h = -1;
         _usage = 0;
         _size = 0;
+        _storage_flags = 0;
+        _mapped = nullptr;
+        _map_offset = 0;
+        _host = nullptr;
+    }
+
+    void *GLBuffer::mapPersistent() {
+        if (_mapped)
+            return _mapped;
+
+        GLbitfield access = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+        if ((_storage_flags & access) != access)
+            throw std::runtime_error("Attempt to persistently map GLBuffer without persistent storage");
+
+        // the null backend's memory stands in for the mapping
+        if (_host)
+            _mapped = _host;
+        else
+            _mapped = (char*)glMapNamedBufferRange(_buf_h, 0, _size, access);
+        if (!_mapped)
+            throw std::runtime_error("Failed to persistently map GLBuffer");
+
+        return _mapped;
+    }
+
+    void GLBuffer::setMapOffset(GLuint offset) {
+        _map_offset = offset;
     }
 
     void GLBuffer::bind(GLenum target) {
         GLuint buf_h = _buf_h;
-        glBindBuffer(target, buf_h);
+        if (!changes(boundBuffer(target, GENERIC_INDEX), buf_h))
+            return;
+
+        record(GLC_BIND, buf_h, 0, 0);
+        if (driver())
+            glBindBuffer(target, buf_h);
     }
 
     void GLBuffer::bindBase(GLenum target, GLuint index) {
         GLuint buf_h = _buf_h;
-        glBindBufferBase(target, index, buf_h); 
+        if (!changes(boundBuffer(target, index), buf_h))
+            return;
+        // also binds the target's generic binding
+        boundBuffer(target, GENERIC_INDEX) = buf_h;
+
+        record(GLC_BIND, buf_h, 0, 0);
+        if (driver())
+            glBindBufferBase(target, index, buf_h); 
     }
 
     void GLBuffer::subData(GLsizeiptr data_size, const void *data, GLsizeiptr offset) {
+        // write straight into mapped memory if mapped
+        if (_mapped) {
+            std::memcpy(_mapped + _map_offset + offset, data, data_size);
+            record(GLC_WRITE, _buf_h, data_size, 0);
+            return;
+        }
+
+        GLuint buf_h = _buf_h;
+        record(GLC_UPLOAD, buf_h, data_size, 0);
+        if (_host)
+            std::memcpy(_host + offset, data, data_size);
+        else
+            glNamedBufferSubData(buf_h, offset, data_size, data);
+    }
+
+    void GLBuffer::copySubData(GLBuffer &src, GLsizeiptr data_size, GLsizeiptr src_offset, GLsizeiptr offset) {
+        GLuint src_h = src._buf_h;
         GLuint buf_h = _buf_h;
-        glNamedBufferSubData(buf_h, offset, data_size, data);
+        record(GLC_COPY, buf_h, data_size, 0);
+        if (_host)
+            std::memmove(_host + offset, src._host + src_offset, data_size);
+        else
+            glCopyNamedBufferSubData(src_h, buf_h, src_offset, offset, data_size);
     }
 
     GLuint GLBuffer::size() { return _size; }
     GLenum GLBuffer::usage() { return _usage; }
     GLuint GLBuffer::handle() { return _buf_h; }
+    bool GLBuffer::mapped() { return _mapped != nullptr; }
 
     const char *GLBuffer::copy_mem() {
+        if (_host) {
+            char *mem = new char[_size];
+            std::memcpy(mem, _host, _size);
+            return mem;
+        }
+
         void *buf = glMapNamedBuffer(_buf_h, GL_READ_ONLY);
         char *mem = new char[_size];
         std::memcpy(mem, buf, _size);
@@ -245,6 +692,170 @@ namespace GLUtil {
         }
     }
 
+    // _______________________________________ GLFence _______________________________________
+
+    GLFence::GLFence() : _sync(nullptr) {}
+
+    GLFence::GLFence(GLFence &&other) : _sync(nullptr) {
+        operator=(std::move(other));
+    }
+
+    GLFence& GLFence::operator=(GLFence &&other) {
+        if (this != &other) {
+            uninit();
+            _sync = other._sync;
+            other._sync = nullptr;
+        }
+        return *this;
+    }
+
+    GLFence::~GLFence() {
+        uninit();
+    }
+
+    void GLFence::place() {
+        uninit();
+        record(GLC_SYNC, 0, 0, 0);
+        if (driver())
+            _sync = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    }
+
+    void GLFence::wait() {
+        if (!_sync)
+            return;
+
+        // flush on the first wait so the fence is guaranteed to be signaled eventually; wait in 1ms steps
+        GLbitfield flags = GL_SYNC_FLUSH_COMMANDS_BIT;
+        while (true) {
+            GLenum res = glClientWaitSync(_sync, flags, 1000000);
+            if (res == GL_ALREADY_SIGNALED || res == GL_CONDITION_SATISFIED)
+                break;
+            if (res == GL_WAIT_FAILED)
+                throw GLErrorException();
+            flags = 0;
+        }
+
+        uninit();
+    }
+
+    void GLFence::uninit() {
+        if (_sync)
+            glDeleteSync(_sync);
+        _sync = nullptr;
+    }
+
+    // _______________________________________ GLFramebuffer _______________________________________
+
+    GLFramebuffer::GLFramebuffer(GLuint width, GLuint height) : _fbo_h(-1), _color_h(0), _depth_h(0), _width(0), _height(0) {
+        init(width, height);
+    }
+    GLFramebuffer::GLFramebuffer() : _fbo_h(-1), _color_h(0), _depth_h(0), _width(0), _height(0) {}
+
+    GLFramebuffer::GLFramebuffer(GLFramebuffer &&other) : _fbo_h(-1), _color_h(0), _depth_h(0), _width(0), _height(0) {
+        operator=(std::move(other));
+    }
+
+    GLFramebuffer& GLFramebuffer::operator=(GLFramebuffer &&other) {
+        if (this != &other) {
+            uninit();
+            _fbo_h = other._fbo_h;
+            _color_h = other._color_h;
+            _depth_h = other._depth_h;
+            _width = other._width;
+            _height = other._height;
+            other._fbo_h = -1;
+            other._color_h = 0;
+            other._depth_h = 0;
+            other._width = 0;
+            other._height = 0;
+        }
+        return *this;
+    }
+
+    GLFramebuffer::~GLFramebuffer() {
+        uninit();
+    }
+
+    void GLFramebuffer::init(GLuint width, GLuint height) {
+        if (_fbo_h != -1)
+            throw InitializedException();
+
+        GLuint fbo_h;
+        if (!driver()) {
+            _fbo_h = ++null_handle;
+            _width = width;
+            _height = height;
+            record(GLC_CREATE, _fbo_h, 0, 0);
+            return;
+        }
+        glCreateFramebuffers(1, &fbo_h);
+
+        // color texture, sampled with nearest filtering if used as a texture
+        glCreateTextures(GL_TEXTURE_2D, 1, &_color_h);
+        glTextureStorage2D(_color_h, 1, GL_RGBA8, width, height);
+        glTextureParameteri(_color_h, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        glTextureParameteri(_color_h, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+        glNamedFramebufferTexture(fbo_h, GL_COLOR_ATTACHMENT0, _color_h, 0);
+
+        // depth renderbuffer
+        glCreateRenderbuffers(1, &_depth_h);
+        glNamedRenderbufferStorage(_depth_h, GL_DEPTH_COMPONENT24, width, height);
+        glNamedFramebufferRenderbuffer(fbo_h, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, _depth_h);
+
+        _fbo_h = fbo_h;
+        _width = width;
+        _height = height;
+        record(GLC_CREATE, _fbo_h, 0, 0);
+
+        if (glCheckNamedFramebufferStatus(fbo_h, GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+            uninit();
+            throw std::runtime_error("Framebuffer is incomplete");
+        }
+    }
+
+    void GLFramebuffer::uninit() {
+        if (_fbo_h != -1) {
+            GLuint fbo_h = _fbo_h;
+            record(GLC_DELETE, fbo_h, 0, 0);
+            if (driver()) {
+                glDeleteFramebuffers(1, &fbo_h);
+                glDeleteTextures(1, &_color_h);
+                glDeleteRenderbuffers(1, &_depth_h);
+            }
+            if (bound_framebuffer == fbo_h)
+                bound_framebuffer = UNKNOWN_BINDING;
+        }
+
+        _fbo_h = -1;
+        _color_h = 0;
+        _depth_h = 0;
+        _width = 0;
+        _height = 0;
+    }
+
+    void GLFramebuffer::bind() {
+        if (changes(bound_framebuffer, _fbo_h)) {
+            record(GLC_BIND, _fbo_h, 0, 0);
+            if (driver())
+                glBindFramebuffer(GL_FRAMEBUFFER, _fbo_h);
+        }
+        setViewport(0, 0, _width, _height);
+    }
+
+    void GLFramebuffer::clear() {
+        GLUtil::clear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+    }
+
+    void GLFramebuffer::blitToDefault(GLuint width, GLuint height) {
+        record(GLC_COPY, _fbo_h, 0, 0);
+        if (driver())
+            glBlitNamedFramebuffer(_fbo_h, default_framebuffer, 0, 0, _width, _height, 0, 0, width, height, GL_COLOR_BUFFER_BIT, GL_NEAREST);
+    }
+
+    GLuint GLFramebuffer::width() { return _width; }
+    GLuint GLFramebuffer::height() { return _height; }
+    GLuint GLFramebuffer::handle() { return _fbo_h; }
+
     // _______________________________________ GLTexture2DArray _______________________________________
 
     GLTexture2DArray::GLTexture2DArray(bool initialize) :
@@ -314,8 +925,12 @@ namespace GLUtil {
             throw InitializedException();
 
         GLuint tex_h = _tex_h;
-        glCreateTextures(GL_TEXTURE_2D_ARRAY, 1, &tex_h);
+        if (driver())
+            glCreateTextures(GL_TEXTURE_2D_ARRAY, 1, &tex_h);
+        else
+            tex_h = ++null_handle;
         _tex_h = tex_h;
+        record(GLC_CREATE, tex_h, 0, 0);
 
         parameteri(GL_TEXTURE_WRAP_S, GL_CLAMP_TO_BORDER);
         parameteri(GL_TEXTURE_WRAP_T, GL_CLAMP_TO_BORDER);
@@ -326,7 +941,10 @@ namespace GLUtil {
     void GLTexture2DArray::uninit() {
         if (_tex_h != -1) {
             GLuint tex_h = _tex_h;
-            glDeleteTextures(1, &tex_h);
+            record(GLC_DELETE, tex_h, 0, 0);
+            if (driver())
+                glDeleteTextures(1, &tex_h);
+            forgetBindings(bound_textures, tex_h);
         }
 
         _tex_h = -1;
@@ -343,12 +961,19 @@ namespace GLUtil {
 
     void GLTexture2DArray::bind(GLenum target) {
         GLuint tex_h = _tex_h;
-        glBindTexture(target, tex_h);
+        if (!changes(bound_textures.emplace(target, UNKNOWN_BINDING).first->second, tex_h))
+            return;
+
+        record(GLC_BIND, tex_h, 0, 0);
+        if (driver())
+            glBindTexture(target, tex_h);
     }
 
     void GLTexture2DArray::parameteri(GLenum param, GLint value) {
         GLuint tex_h = _tex_h;
-        glTextureParameteri(tex_h, param, value);
+        record(GLC_STATE, tex_h, 0, 0);
+        if (driver())
+            glTextureParameteri(tex_h, param, value);
     }
 
     void GLTexture2DArray::alloc(GLint levels, GLenum store_format, GLenum data_format, GLenum type, GLsizei width, GLsizei height, GLsizei depth) {
@@ -362,14 +987,18 @@ namespace GLUtil {
         _width = width;
         _height = height;
         _depth = depth;
-        glTextureStorage3D(_tex_h, levels, store_format, width, height, depth);
+        record(GLC_CREATE, _tex_h, GLsizeiptr(width) * height * depth * pixelBytes(data_format, type), 0);
+        if (driver())
+            glTextureStorage3D(_tex_h, levels, store_format, width, height, depth);
 
         _allocated = true;
     }
 
     void GLTexture2DArray::subImage(GLint level, GLint x_offset, GLint y_offset, GLint z_offset, GLsizei width, GLsizei height, GLsizei depth, const void *data) {
         GLuint tex_h = _tex_h;
-        glTextureSubImage3D(tex_h, level, x_offset, y_offset, z_offset, width, height, depth, _data_format, _type, data);
+        record(GLC_UPLOAD, tex_h, GLsizeiptr(width) * height * depth * pixelBytes(_data_format, _type), 0);
+        if (driver())
+            glTextureSubImage3D(tex_h, level, x_offset, y_offset, z_offset, width, height, depth, _data_format, _type, data);
     }
 
     GLuint GLTexture2DArray::size() { return _size; }
@@ -528,6 +1157,10 @@ namespace GLUtil {
     // ______________________________________________________________________________
 
     void render(GLenum mode, GLsizei count, bool with_elements) {
+        record(GLC_DRAW, 0, 0, 1);
+        if (!driver())
+            return;
+
         if (with_elements)
             glDrawElements(mode, count, GL_UNSIGNED_INT, nullptr);
         else
@@ -535,17 +1168,128 @@ namespace GLUtil {
     }
 
     void renderInst(GLenum mode, GLsizei count, GLuint numinst, bool with_elements) {
+        record(GLC_DRAW, 0, 0, numinst);
+        if (!driver())
+            return;
+
         if (with_elements)
             glDrawElementsInstanced(mode, count, GL_UNSIGNED_INT, nullptr, numinst);
         else
             glDrawArraysInstanced(mode, 0, count, numinst);
     }
 
+    void renderInstBase(GLenum mode, GLsizei count, GLuint numinst, GLuint baseinst, bool with_elements) {
+        record(GLC_DRAW, 0, 0, numinst);
+        if (!driver())
+            return;
+
+        if (with_elements)
+            glDrawElementsInstancedBaseInstance(mode, count, GL_UNSIGNED_INT, nullptr, numinst, baseinst);
+        else
+            glDrawArraysInstancedBaseInstance(mode, 0, count, numinst, baseinst);
+    }
+
+    void renderMultiIndirect(GLenum mode, GLsizei draw_count) {
+        record(GLC_DRAW, 0, 0, draw_count);
+        if (driver())
+            glMultiDrawElementsIndirect(mode, GL_UNSIGNED_INT, nullptr, draw_count, 0);
+    }
+
+    void setBlending(bool enabled) {
+        if (!changes(blending, enabled))
+            return;
+
+        record(GLC_STATE, 0, 0, 0);
+        if (!driver())
+            return;
+
+        if (enabled) {
+            glEnable(GL_BLEND);
+            glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+        } else
+            glDisable(GL_BLEND);
+    }
+
+    void clear(GLbitfield mask) {
+        record(GLC_STATE, 0, 0, 0);
+        if (driver())
+            glClear(mask);
+    }
+
     void setViewport(GLint x, GLint y, GLint width, GLint height) {
-        glViewport(x, y, width, height);
+        if (bound_viewport[0] == x && bound_viewport[1] == y && bound_viewport[2] == width && bound_viewport[3] == height) {
+            state_stats.skipped++;
+            return;
+        }
+        bound_viewport[0] = x;
+        bound_viewport[1] = y;
+        bound_viewport[2] = width;
+        bound_viewport[3] = height;
+        state_stats.issued++;
+
+        record(GLC_STATE, 0, 0, 0);
+        if (driver())
+            glViewport(x, y, width, height);
+    }
+
+    void bindDefaultFramebuffer() {
+        if (!changes(bound_framebuffer, default_framebuffer))
+            return;
+
+        record(GLC_BIND, default_framebuffer, 0, 0);
+        if (driver())
+            glBindFramebuffer(GL_FRAMEBUFFER, default_framebuffer);
+    }
+
+    void setDefaultFramebuffer(GLuint handle) {
+        default_framebuffer = handle;
+    }
+
+    void unbindBuffer(GLenum target) {
+        if (!changes(boundBuffer(target, GENERIC_INDEX), 0))
+            return;
+
+        record(GLC_BIND, 0, 0, 0);
+        if (driver())
+            glBindBuffer(target, 0);
+    }
+
+    void setProgramCacheDir(const char *dir) {
+        program_cache_dir = dir;
+        if (!program_cache_dir.empty())
+            std::filesystem::create_directories(program_cache_dir);
+    }
+
+    void setBackend(GLBackend backend) {
+        GLUtil::backend = backend;
+    }
+
+    GLBackend getBackend() { return backend; }
+
+    GLCommandLog &commandLog() { return command_log; }
+
+    GLStateStats getStateStats() { return state_stats; }
+
+    void clearStateStats() {
+        state_stats = GLStateStats();
+    }
+
+    void resetStateCache() {
+        bound_program = UNKNOWN_BINDING;
+        bound_vao = UNKNOWN_BINDING;
+        bound_framebuffer = UNKNOWN_BINDING;
+        for (GLint &value : bound_viewport)
+            value = -1;
+        blending = UNKNOWN_BINDING;
+        bound_buffers.clear();
+        bound_textures.clear();
     }
 
     void glinit(bool debug) {
+        resetStateCache();
+        if (!driver())
+            return;
+
         // initialize glew
         glewInit();
         if (debug)
@@ -0,0 +1,97 @@
+#include "../include/imageloader.hpp"
+
+// milliseconds elapsed since the provided time point
+static double elapsedMs(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+void ImageLoader::_work() {
+    while (true) {
+        unsigned i = _next++;
+        if (i >= _filenames.size())
+            return;
+
+        // each worker only writes the entries of the indices it claimed
+        auto start = std::chrono::steady_clock::now();
+        try {
+            _images[i].load(_filenames[i].c_str());
+        } catch (...) {
+            _errors[i] = std::current_exception();
+        }
+        _timings[i].decode = elapsedMs(start);
+        _decoded[i] = std::chrono::steady_clock::now();
+    }
+}
+
+ImageLoader::ImageLoader() : _next(0) {}
+ImageLoader::~ImageLoader() {
+    for (std::thread &worker : _workers)
+        worker.join();
+}
+
+void ImageLoader::start(const std::vector<std::string> &filenames, unsigned threads) {
+    if (!_workers.empty())
+        throw InitializedException();
+
+    _filenames = filenames;
+    _images = std::vector<Image>(filenames.size());
+    _timings = std::vector<ImageTiming>(filenames.size());
+    _errors = std::vector<std::exception_ptr>(filenames.size());
+    _start = std::chrono::steady_clock::now();
+    _decoded = std::vector<std::chrono::steady_clock::time_point>(filenames.size(), _start);
+    _next = 0;
+
+    if (threads == 0)
+        threads = std::max(std::thread::hardware_concurrency(), 1u);
+    threads = std::min(threads, unsigned(filenames.size()));
+    for (unsigned i = 0; i < threads; i++)
+        _workers.push_back(std::thread(&ImageLoader::_work, this));
+}
+
+void ImageLoader::wait() {
+    for (std::thread &worker : _workers)
+        worker.join();
+    _workers.clear();
+
+    for (unsigned i = 0; i < _errors.size(); i++) {
+        if (_errors[i]) {
+            std::cerr << "Error decoding image '" << _filenames[i] << "'" << std::endl;
+            std::rethrow_exception(_errors[i]);
+        }
+    }
+}
+
+void ImageLoader::upload(const std::function<void(unsigned, const Image&)> &upload) {
+    wait();
+
+    for (unsigned i = 0; i < _images.size(); i++) {
+        auto start = std::chrono::steady_clock::now();
+        upload(i, _images[i]);
+        _timings[i].upload = elapsedMs(start);
+        _images[i] = Image();
+    }
+}
+
+Image &ImageLoader::image(unsigned i) { return _images.at(i); }
+
+const ImageTiming &ImageLoader::timing(unsigned i) { return _timings.at(i); }
+
+unsigned ImageLoader::count() { return _filenames.size(); }
+
+double ImageLoader::decodeWallTime() {
+    auto end = _start;
+    for (auto &decoded : _decoded)
+        end = std::max(end, decoded);
+    return std::chrono::duration<double, std::milli>(end - _start).count();
+}
+
+void ImageLoader::printTimings(std::ostream &out) {
+    double decode = 0.0;
+    double upload = 0.0;
+    for (unsigned i = 0; i < _filenames.size(); i++) {
+        out << "'" << _filenames[i] << "': decode " << _timings[i].decode << " ms, upload " << _timings[i].upload << " ms" << std::endl;
+        decode += _timings[i].decode;
+        upload += _timings[i].upload;
+    }
+    out << "total: decode " << decode << " ms (" << decodeWallTime() << " ms wall clock), upload " << upload << " ms" << std::endl;
+}
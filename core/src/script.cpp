@@ -4,13 +4,19 @@ Script::Script(Script &&other) { operator=(std::move(other)); }
 Script::Script() :
     _executor(nullptr),
     _executor_id(0),
+    _allocator(nullptr),
+    _prev_script(nullptr),
+    _next_script(nullptr),
     _last_execqueue(-1),
+    _persistent_queue(-1),
+    _persistent_index(0),
     _remove_on_kill(false),
+    _recycle(false),
     _initialized(false), 
     _killed(false), 
     _exec_enqueued(false), 
     _kill_enqueued(false),
-    _script_name(""),
+    _script_type{0},
     _group(-1)
 {}
 Script::~Script() { /* automatic destruction is fine */ }
@@ -19,24 +25,35 @@ Script &Script::operator=(Script &&other) {
     if (this != &other) {
         _executor = other._executor;
         _executor_id = other._executor_id;
-        _this_iter = other._this_iter;
+        _allocator = other._allocator;
+        _prev_script = other._prev_script;
+        _next_script = other._next_script;
         _last_execqueue = other._last_execqueue;
+        _persistent_queue = other._persistent_queue;
+        _persistent_index = other._persistent_index;
         _remove_on_kill = other._remove_on_kill;
+        _recycle = other._recycle;
         _initialized = other._initialized;
         _killed = other._killed;
         _exec_enqueued = other._exec_enqueued;
         _kill_enqueued = other._exec_enqueued;
-        _script_name = other._script_name;
+        _script_type = other._script_type;
         _group = other._group;
         other._executor = nullptr;
         other._executor_id = 0;
+        other._allocator = nullptr;
+        other._prev_script = nullptr;
+        other._next_script = nullptr;
         other._last_execqueue = -1;
+        other._persistent_queue = -1;
+        other._persistent_index = 0;
         other._remove_on_kill = false;
+        other._recycle = false;
         other._initialized = false;
         other._killed = false;
         other._exec_enqueued = false;
         other._exec_enqueued = false;
-        other._script_name = "";
+        other._script_type = ScriptType{0};
         other._group = -1;
     }
     return *this;
@@ -49,6 +66,9 @@ void Script::_scriptErase() {
     _executor = nullptr;
 }
 
+void Script::_reset() {}
+void Script::_release() {}
+
 void Script::runInit() {
     if (_executor)
         _init();
@@ -69,7 +89,11 @@ bool Script::getInitialized() { return _initialized; }
 bool Script::getKilled() { return _killed; }
 bool Script::getExecEnqueued() { return _exec_enqueued; }
 bool Script::getKillEnqueued() { return _kill_enqueued; }
-const char *Script::getName() { return _script_name.c_str(); }
+bool Script::getPersistent() { return _persistent_queue >= 0; }
+int Script::getPersistentQueue() { return _persistent_queue; }
+bool Script::getRecycle() { return _recycle; }
+const char *Script::getName() { return _executor ? _executor->getTypeName(_script_type) : ""; }
+ScriptType Script::getType() { return _script_type; }
 int Script::getGroup() { return _group; }
 
 void Script::enqueueExec(unsigned queue) {
@@ -86,6 +110,18 @@ void Script::enqueueKill() {
         _executor->enqueueKill(this);
 }
 
+void Script::enqueuePersistent(unsigned queue) {
+    if (!_executor)
+        throw std::runtime_error("Attempt to enqueue for persistent execution with null Executor owner");
+    if (!_killed)
+        _executor->enqueuePersistent(this, queue);
+}
+
+void Script::pausePersistent() {
+    if (_executor)
+        _executor->pausePersistent(this);
+}
+
 Executor &Script::executor() {
     return *_executor; 
 }
@@ -96,31 +132,31 @@ unsigned Script::getExecutorID() {
 
 // --------------------------------------------------------------------------------------------------------------------------
 
-Script *Executor::ScriptEnqueue::spawn() {
-    return _executor->_spawnScript(_name.c_str(), _execution_queue, _tag);
+Executor::Executor(unsigned queues) : _scripts(nullptr), _script_count(0), _initialized(false) { init(queues); }
+Executor::Executor() : _scripts(nullptr), _script_count(0), _initialized(false) {}
+Executor::Executor(Executor &&other) : _scripts(nullptr), _script_count(0), _initialized(false) { operator=(std::move(other)); }
+Executor::~Executor() {
+    // owned Scripts must be handed back to their allocators
+    uninit();
 }
-Executor::ScriptEnqueue::ScriptEnqueue(Executor *executor, std::string name, int execution_queue, int tag) :
-    _executor(executor), _name(name), _execution_queue(execution_queue), _tag(tag)
-{}
-Executor::ScriptEnqueue::~ScriptEnqueue() { /* automatic destruction is fine */ }
-
-Executor::Executor(unsigned queues) { init(queues); }
-Executor::Executor() : _initialized(false) {}
-Executor::Executor(Executor &&other) { operator=(std::move(other)); }
-Executor::~Executor() { /* automatic destruction is fine */ }
 
 Executor &Executor::operator=(Executor &&other) {
     if (this != &other) {
-        std::queue<Script*> empty1;
-        std::queue<Script*> empty2;
-
-        _scripts.move(other._scripts);
+        _scripts = other._scripts;
+        _script_count = other._script_count;
         _intgen = other._intgen;
-        _scriptinfos = other._scriptinfos;
-        _scriptenqueues.move(other._scriptenqueues);
-        _queuepairs = other._queuepairs;
-        _push_killqueue = other._push_killqueue;
-        _run_killqueue = other._run_killqueue;
+        _scriptinfos = std::move(other._scriptinfos);
+        _scripttypes = std::move(other._scripttypes);
+        _spawnrecords = std::move(other._spawnrecords);
+        other._scriptinfos.clear();
+        other._scripttypes.clear();
+        other._spawnrecords.clear();
+        _queuepairs = std::move(other._queuepairs);
+        _push_killqueue = std::move(other._push_killqueue);
+        _run_killqueue = std::move(other._run_killqueue);
+        _initialized = other._initialized;
+        other._scripts = nullptr;
+        other._script_count = 0;
 
         // safe as structures owning memory are already moved
         other.uninit();
@@ -128,39 +164,128 @@ Executor &Executor::operator=(Executor &&other) {
     return *this;
 }
 
-void Executor::_setupScript(Script *script, const char *script_name, int execution_queue) {
+void Executor::_linkScript(Script *script) {
+    script->_prev_script = nullptr;
+    script->_next_script = _scripts;
+    if (_scripts)
+        _scripts->_prev_script = script;
+    _scripts = script;
+    _script_count++;
+}
+
+void Executor::_unlinkScript(Script *script) {
+    if (script->_prev_script)
+        script->_prev_script->_next_script = script->_next_script;
+    else
+        _scripts = script->_next_script;
+    if (script->_next_script)
+        script->_next_script->_prev_script = script->_prev_script;
+    script->_prev_script = nullptr;
+    script->_next_script = nullptr;
+    _script_count--;
+}
+
+void Executor::_removePersistent(Script *script) {
+    if (script->_persistent_queue < 0)
+        return;
+
+    // leave a null slot, so that a running execution of the queue is not disturbed
+    QueuePair &queuepair = _queuepairs[script->_persistent_queue];
+    queuepair._persistent[script->_persistent_index] = nullptr;
+    queuepair._persistent_removed++;
+    script->_persistent_queue = -1;
+}
+
+void Executor::_compactPersistent(QueuePair &queuepair) {
+    std::vector<Script*> &persistent = queuepair._persistent;
+
+    unsigned count = 0;
+    for (unsigned i = 0; i < persistent.size(); i++) {
+        if (persistent[i]) {
+            persistent[count] = persistent[i];
+            persistent[count]->_persistent_index = count;
+            count++;
+        }
+    }
+    persistent.resize(count);
+    queuepair._persistent_removed = 0;
+}
+
+Script *Executor::_takeRecycled(ScriptType type, int tag) {
+    std::vector<Script*> &recycled = _scriptinfos[type.index]._recycled;
+    if (recycled.empty())
+        return nullptr;
+
+    Script *script = recycled.back();
+    recycled.pop_back();
+
+    // restore the state of a newly allocated Script, and let its allocator treat it as allocated
+    script->_reset();
+    script->_last_execqueue = -1;
+    script->_initialized = false;
+    script->_killed = false;
+    script->_exec_enqueued = false;
+    script->_kill_enqueued = false;
+    script->_allocator->_reuse(script, tag);
+
+    return script;
+}
+
+void Executor::_setupScript(Script *script, AllocatorInterface *allocator, ScriptType type, int execution_queue) {
     // get information
-    ScriptInfo &info = _scriptinfos[script_name];
+    ScriptInfo &info = _scriptinfos[type.index];
 
     // store data
     script->_executor = this;
     script->_executor_id = _intgen.push();
-    script->_this_iter = _scripts.push_back(script);
+    script->_allocator = allocator;
+    _linkScript(script);
 
-    // set script fields (make copy of string passed)
+    // set script fields
     script->_remove_on_kill = info._remove_on_kill;
-    script->_script_name = script_name;
+    script->_recycle = info._recycle;
+    script->_script_type = type;
     script->_group = info._group;
     
-    // enqueue if non-negative queue provided
-    if (execution_queue >= 0)
-        enqueueExec(script, execution_queue);
+    // enqueue if non-negative queue provided, persistently if set for the name
+    if (execution_queue >= 0) {
+        if (info._persistent)
+            enqueuePersistent(script, execution_queue);
+        else
+            enqueueExec(script, execution_queue);
+    }
     
     // try spawn callback if it exists
     if (info._spawn_callback)
         info._spawn_callback(script);
 }
 
-Script *Executor::_spawnScript(const char *script_name, int execution_queue, int tag) {
-    // allocate instance and set it up
-    Script *script = _scriptinfos[script_name]._allocator->_allocate(tag);
-    _setupScript(script, script_name, execution_queue);
+Script *Executor::_spawnScript(ScriptType type, int execution_queue, int tag) {
+    // reuse a recycled instance if there is one, otherwise allocate one, and set it up
+    AllocatorInterface *allocator = _scriptinfos[type.index]._allocator;
+    Script *script = _takeRecycled(type, tag);
+    if (!script)
+        script = allocator->_allocate(tag);
+    _setupScript(script, allocator, type, execution_queue);
     return script;
 }
 
-void Executor::_pushSpawnEnqueue(ScriptEnqueue *enqueue) {
-    _scriptenqueues.push(enqueue);
-};
+void Executor::_pushSpawnRecord(SpawnRecord record) {
+    _spawnrecords.push_back(record);
+}
+
+Script *Executor::_spawnRecord(const SpawnRecord &record) {
+    return _spawnScript(record._type, record._execution_queue, record._tag);
+}
+
+void Executor::_clearSpawnRecords() {
+    _spawnrecords.clear();
+}
+
+void Executor::_checkType(ScriptType type) {
+    if (type.index >= _scriptinfos.size())
+        throw std::out_of_range("Script type index out of range");
+}
 
 void Executor::_checkOwned(Script *script) {
     if (script->_executor != this)
@@ -179,41 +304,92 @@ void Executor::uninit() {
     if (!_initialized)
         return;
 
-    std::queue<Script*> empty1;
-    std::queue<Script*> empty2;
+    // hand every owned Script back to its allocator
+    while (_scripts) {
+        Script *script = _scripts;
+        _unlinkScript(script);
+        script->_allocator->_deallocate(script);
+    }
+    for (auto &scriptinfo : _scriptinfos) {
+        for (Script *script : scriptinfo._recycled) {
+            script->_release();
+            script->_allocator->_deallocate(script);
+        }
+    }
 
-    _scripts.clear();
     _intgen.clear();
     _scriptinfos.clear();
-    _scriptenqueues.clear();
+    _scripttypes.clear();
+    _spawnrecords.clear();
+    _spawned.clear();
     _queuepairs.clear();
-    _push_killqueue.swap(empty1);
-    _run_killqueue.swap(empty2);
+    _push_killqueue.clear();
+    _run_killqueue.clear();
+    _initialized = false;
 }
 
 void Executor::erase(Script *script) {
     _checkOwned(script);
 
     // get values and info
-    ScriptInfo &scriptinfo = _scriptinfos[script->_script_name];
+    ScriptInfo &scriptinfo = _scriptinfos[script->_script_type.index];
 
     // try removal callback if it exists
     if (scriptinfo._remove_callback)
         scriptinfo._remove_callback(script);
 
     _intgen.remove(script->_executor_id);
-    _scripts.erase(script->_this_iter);
-}
+    _unlinkScript(script);
+    _removePersistent(script);
 
-void Executor::add(AllocatorInterface *allocator, const char *name, int group, bool remove_on_kill, std::function<void(Script*)> spawn_callback, std::function<void(Script*)> remove_callback) {  
-    if (!hasAdded(name))
-        _scriptinfos[name] = ScriptInfo{group, remove_on_kill, allocator, spawn_callback, remove_callback};
+    // keep killed Scripts for reuse if recycling, otherwise release them
+    if (script->_recycle && script->_killed)
+        scriptinfo._recycled.push_back(script);
     else
+        script->_allocator->_deallocate(script);
+}
+
+ScriptType Executor::add(AllocatorInterface *allocator, const char *name, int group, bool remove_on_kill, std::function<void(Script*)> spawn_callback, std::function<void(Script*)> remove_callback) {  
+    if (hasAdded(name))
         throw std::runtime_error("Attempt to add already added Script name");
+
+    ScriptType type{unsigned(_scriptinfos.size())};
+    _scriptinfos.push_back(ScriptInfo{name, group, remove_on_kill, false, false, allocator, spawn_callback, remove_callback, {}});
+    _scripttypes[name] = type.index;
+    return type;
+}
+
+void Executor::setRecycle(const char *name, bool recycle) {
+    if (!hasAdded(name))
+        throw std::runtime_error("Attempt to set recycling of Script name that has not been added");
+
+    ScriptInfo &info = _scriptinfos[_scripttypes[name]];
+    info._recycle = recycle;
+
+    // release kept Scripts if no longer recycling
+    if (!recycle) {
+        for (Script *script : info._recycled) {
+            script->_release();
+            script->_allocator->_deallocate(script);
+        }
+        info._recycled.clear();
+    }
+}
+
+void Executor::setPersistent(const char *name, bool persistent) {
+    if (!hasAdded(name))
+        throw std::runtime_error("Attempt to set persistence of Script name that has not been added");
+
+    _scriptinfos[_scripttypes[name]]._persistent = persistent;
+}
+
+void Executor::enqueueSpawn(ScriptType type, int execution_queue, int tag) {
+    _checkType(type);
+    _pushSpawnRecord(SpawnRecord{type, execution_queue, tag, 0});
 }
 
 void Executor::enqueueSpawn(const char *script_name, int execution_queue, int tag) {
-    _pushSpawnEnqueue(new ScriptEnqueue(this, script_name, execution_queue, tag));
+    enqueueSpawn(getType(script_name), execution_queue, tag);
 }
 
 void Executor::enqueueExec(Script *script, unsigned queue) {
@@ -222,9 +398,13 @@ void Executor::enqueueExec(Script *script, unsigned queue) {
     if (queue >= _queuepairs.size())
         throw std::out_of_range("Execution queue index out of range");
 
+    // persistent Scripts already run on every execution of their queue
+    if (script->_persistent_queue == int(queue))
+        return;
+
     if (!(script->_exec_enqueued)) {
         // push to specified pair
-        _queuepairs[queue]._push_execqueue.push(script);
+        _queuepairs[queue]._push_execqueue.push_back(script);
         script->_exec_enqueued = true;
     }
 }
@@ -234,21 +414,44 @@ void Executor::enqueueKill(Script *script) {
 
     if (!(script->_kill_enqueued)) {
         // push to kill queue
-        _push_killqueue.push(script);
+        _push_killqueue.push_back(script);
         script->_kill_enqueued = true;
     }
 }
 
-std::vector<Script*> Executor::runSpawnQueue() {
-    std::vector<Script*> scripts;
+void Executor::enqueuePersistent(Script *script, unsigned queue) {
+    _checkOwned(script);
+
+    if (queue >= _queuepairs.size())
+        throw std::out_of_range("Execution queue index out of range");
+
+    if (script->_persistent_queue == int(queue))
+        return;
+
+    // move from another persistent queue, and append to this one
+    _removePersistent(script);
+    std::vector<Script*> &persistent = _queuepairs[queue]._persistent;
+    script->_persistent_queue = queue;
+    script->_persistent_index = persistent.size();
+    persistent.push_back(script);
+}
+
+void Executor::pausePersistent(Script *script) {
+    _checkOwned(script);
+    _removePersistent(script);
+}
 
-    while (!(_scriptenqueues.empty())) {
-        ScriptEnqueue *scriptenqueue = _scriptenqueues.front();
-        scripts.push_back(scriptenqueue->spawn());
-        _scriptenqueues.pop();
+const std::vector<Script*> &Executor::runSpawnQueue() {
+    _spawned.clear();
+
+    // spawning may enqueue more spawns, growing the records; copy each record out before spawning
+    for (unsigned i = 0; i < _spawnrecords.size(); i++) {
+        SpawnRecord record = _spawnrecords[i];
+        _spawned.push_back(_spawnRecord(record));
     }
+    _clearSpawnRecords();
 
-    return scripts;
+    return _spawned;
 }
 
 void Executor::runExecQueue(unsigned queue) {
@@ -256,20 +459,42 @@ void Executor::runExecQueue(unsigned queue) {
     if (queue >= _queuepairs.size())
         throw std::out_of_range("Execution queue index out of range");
     
-    std::queue<Script*> &push_execqueue = _queuepairs[queue]._push_execqueue;
-    std::queue<Script*> &run_execqueue = _queuepairs[queue]._run_execqueue;
+    QueuePair &queuepair = _queuepairs[queue];
+    std::vector<Script*> &push_execqueue = queuepair._push_execqueue;
+    std::vector<Script*> &run_execqueue = queuepair._run_execqueue;
+    std::vector<Script*> &persistent = queuepair._persistent;
+
+    // run persistent Scripts first; Scripts removed while running leave null slots, and Scripts added while running
+    // are only run from the next execution
+    if (queuepair._persistent_removed)
+        _compactPersistent(queuepair);
+    unsigned persistent_count = persistent.size();
+    for (unsigned i = 0; i < persistent_count; i++) {
+        Script *script = persistent[i];
+        if (!script || script->_killed)
+            continue;
+
+        script->_last_execqueue = queue;
+        if (!(script->_initialized)) {
+            script->runInit();
+            script->_initialized = true;
+        }
+        script->runBase();
+    }
     
-    // swap queues
+    // swap queues (Scripts enqueued while running go into the other buffer)
     run_execqueue.swap(push_execqueue);
 
-    Script *script;
-    while (!(run_execqueue.empty())) {
-        script = run_execqueue.front();
+    for (Script *script : run_execqueue) {
         _checkOwned(script);
 
         script->_last_execqueue = queue;
         script->_exec_enqueued = false;
 
+        // skip Scripts made persistent on this queue since being enqueued
+        if (script->_persistent_queue == int(queue))
+            continue;
+
         // check if script hasn't been killed yet
         if (!(script->_killed)) {
             // check if script needs to be initialized
@@ -280,24 +505,22 @@ void Executor::runExecQueue(unsigned queue) {
 
             script->runBase();
         }
-        
-        run_execqueue.pop();
     }
+    run_execqueue.clear();
 }
 
 void Executor::runKillQueue() {
-    // swap queues
+    // swap queues (Scripts enqueued while killing go into the other buffer)
     _run_killqueue.swap(_push_killqueue);
 
-    Script *script;
-    while (!(_run_killqueue.empty())) {
-        script = _run_killqueue.front();
+    for (Script *script : _run_killqueue) {
         _checkOwned(script);
 
         // check if script needs to be killed
         if (!(script->_killed)) {
             script->runKill();
             script->_killed = true;
+            _removePersistent(script);
 
             // remove the script after killing it
             if (script->_remove_on_kill)
@@ -305,18 +528,29 @@ void Executor::runKillQueue() {
             else
                 script->_kill_enqueued = false;
         }
-        
-        _run_killqueue.pop();
     }
+    _run_killqueue.clear();
 }
 
-bool Executor::hasAdded(const char *scriptname) { return !(_scriptinfos.find(scriptname) == _scriptinfos.end()); }
+bool Executor::hasAdded(const char *scriptname) { return !(_scripttypes.find(scriptname) == _scripttypes.end()); }
+
+ScriptType Executor::getType(const char *script_name) {
+    auto type = _scripttypes.find(script_name);
+    if (type == _scripttypes.end())
+        throw std::runtime_error("Attempt to get type of Script name that has not been added");
+    return ScriptType{type->second};
+}
+
+const char *Executor::getTypeName(ScriptType type) {
+    _checkType(type);
+    return _scriptinfos[type.index]._name.c_str();
+}
 
 bool Executor::has(Script *script) {
     return (script->_executor == this);
 }
 
-unsigned Executor::getCount() { return _scripts.size(); }
+unsigned Executor::getCount() { return _script_count; }
 
 int Executor::getQueueCount() { return _queuepairs.size(); }
 
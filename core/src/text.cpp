@@ -2,6 +2,8 @@
 
 Text::Text(GLEnv *glenv) : 
     _glenv(glenv), 
+    _first_quad(0),
+    _quad_count(0),
     _tc(TextConfig{0, 0, 0, 0, 0, 0, 0, 0, 0, 0}),
     _pos(glm::vec3(0.0f)),
     _scale(glm::vec3(1.0f)),
@@ -12,22 +14,23 @@ Text::Text(Text &&other) { operator=(std::move(other)); }
 
 Text::~Text() {
     // erase all characters from glenv
-    if (_glenv)
-        for (unsigned i = 0; i < _quadids.size(); i++)
-            _glenv->remove(_quadids[i]);
+    if (_glenv && _quad_count)
+        _glenv->removeQuads(_first_quad, _quad_count);
 }
 
 Text &Text::operator=(Text &&other) {
     if (this != &other) {
         _glenv = other._glenv;
-        _quadids = other._quadids;
+        _first_quad = other._first_quad;
+        _quad_count = other._quad_count;
         _tc = other._tc;
         _textstr = other._textstr;
         _pos = other._pos;
         _scale = other._scale;
         _update = other._update;
         other._glenv = nullptr;
-        other._quadids.clear();
+        other._first_quad = 0;
+        other._quad_count = 0;
         other._tc = TextConfig{};
         other._pos = glm::vec3(0.0f);
         other._scale = glm::vec3(0.0f);
@@ -87,25 +90,15 @@ void Text::update() {
     if (!_glenv)
         throw std::runtime_error("WARN: attempt to update Text with null GLEnv reference");
 
-    int l_ids = _quadids.size();
     int l_str = _textstr.size();
 
-    // can only be true if previous generation has occurred
-    if (l_str < l_ids) {
-        // erase extra characters from glenv
-        for (int i = l_str; i < l_ids; i++)
-            _glenv->remove(_quadids[i]);
-        
-        // create new vector with previous IDs
-        std::vector<int> _newids;
-        for (int i = 0; i < l_str; i++)
-            _newids.push_back(_quadids[i]);
-        _quadids = _newids;
-
-    } else {
-        // push new IDs to vector (TODO: assign proper values on generation)
-        for (int i = l_ids; i < l_str; i++)
-            _quadids.push_back(_glenv->genQuad(glm::vec3(0.0f), glm::vec3(0.0f), glm::vec4(1.0f), glm::vec3(0.0f), glm::vec2(0.0f), GLE_RECT));
+    // replace the range of Quads if the length changed, so that characters stay in contiguous slots
+    if (unsigned(l_str) != _quad_count) {
+        if (_quad_count)
+            _glenv->removeQuads(_first_quad, _quad_count);
+        _quad_count = l_str;
+        if (_quad_count)
+            _first_quad = _glenv->genQuads(_quad_count, glm::vec3(0.0f), glm::vec3(0.0f), glm::vec4(1.0f), glm::vec3(0.0f), glm::vec2(0.0f), GLE_RECT);
     }
     
     // set position start to be half-way leftward across complete text width, to center the text
@@ -115,18 +108,18 @@ void Text::update() {
     
     // update IDs with new character information
     for (int i = 0; i < l_str; i++) {
-        quad = _glenv->getQuad(_quadids[i]);
+        quad = _glenv->getQuad(_first_quad + i);
         int charpos = int(_textstr[i]) - 32;
 
         // set values according to configuration and string
-        quad->bv_pos.v = _pos + glm::vec3(pos_start + float(shift * i), 0.0f, 0.0f);
-        quad->bv_scale.v = glm::vec3(_tc.text_width, _tc.text_height, 0.0f) * _scale;
-        quad->bv_texpos.v = glm::vec3(
+        quad->setPos(_pos + glm::vec3(pos_start + float(shift * i), 0.0f, 0.0f));
+        quad->setScale(glm::vec3(_tc.text_width, _tc.text_height, 0.0f) * _scale);
+        quad->setTexPos(glm::vec3(
             _tc.tex_x + ((_tc.text_width + _tc.text_xoff) * (charpos % _tc.tex_columns)),
             _tc.tex_y + ((_tc.text_height + _tc.text_yoff) * int(charpos / _tc.tex_columns)),
             _tc.tex_z
-        );
-        quad->bv_texsize.v = glm::vec2(_tc.text_width, _tc.text_height);
+        ));
+        quad->setTexSize(glm::vec2(_tc.text_width, _tc.text_height));
     }
 
     _update = false;
@@ -0,0 +1,395 @@
+#include "../include/textenv.hpp"
+
+// expands each character of a string instance into a quad, laying out glyphs as Text does; vertices of characters
+// past the string's length are placed outside the clip volume
+const char * const text_vert_shader_str = R"(
+    #version 450
+
+    layout(location = 1) in vec3 v_pos;
+    layout(location = 2) in vec3 v_scale;
+    layout(location = 3) in vec4 v_color;
+    // font, first glyph word, and length
+    layout(location = 4) in uvec4 v_text;
+
+    layout(location = 8) uniform mat4 u_view;
+    layout(location = 9) uniform mat4 u_proj;
+
+    // texture position and columns of sheet, glyph size and spacing in sheet, and spacing between characters
+    struct Font {
+        ivec4 tex;
+        ivec4 glyph;
+        ivec4 spacing;
+    };
+    layout(std430, binding = 2) readonly buffer Fonts { Font fonts[]; };
+    layout(std430, binding = 3) readonly buffer Glyphs { uint glyphs[]; };
+
+    out vec4 f_color;
+    out vec3 f_texcoords;
+
+    // unit quad positioned at (0, 0) to (1, 1), as two triangles
+    const vec2 corners[6] = vec2[](vec2(0.0, 0.0), vec2(1.0, 0.0), vec2(0.0, 1.0), vec2(1.0, 0.0), vec2(0.0, 1.0), vec2(1.0, 1.0));
+
+    void main() {
+        uint index = uint(gl_VertexID) / 6u;
+        if (index >= v_text.z) {
+            gl_Position = vec4(2.0, 2.0, 2.0, 1.0);
+            return;
+        }
+
+        Font font = fonts[v_text.x];
+        int charpos = int((glyphs[v_text.y + (index / 4u)] >> (8u * (index % 4u))) & 0xFFu) - 32;
+        vec4 model = vec4(corners[gl_VertexID % 6], 0.0, 1.0);
+
+        // place character along the string, shifted half-way leftward across its complete width to center it
+        float width = float(font.glyph.x) * v_scale.x;
+        float shift = float(int(width) + font.spacing.x);
+        float start = ((float(v_text.z) * width) + (float(int(v_text.z) - 1) * float(font.spacing.x))) * -0.5;
+        vec3 pos = v_pos + vec3(start + (shift * float(index)), 0.0, 0.0);
+        vec3 scale = vec3(font.glyph.xy, 0.0) * v_scale;
+
+        // find character in sheet
+        vec3 texpos = vec3(
+            font.tex.x + ((font.glyph.x + font.glyph.z) * (charpos % font.tex.w)),
+            font.tex.y + ((font.glyph.y + font.glyph.w) * (charpos / font.tex.w)),
+            font.tex.z
+        );
+        vec2 texsize = vec2(font.glyph.xy);
+
+        f_color = v_color;
+        f_texcoords = texpos + (vec3(texsize, 0.0) * vec3(model.x, 1.0 - model.y, 0.0));
+
+        vec4 final_pos = ((model + vec4(-0.5f, -0.5f, 0.0f, 0.0f)) * vec4(scale, 1.0f)) + vec4(pos, 0.0f);
+        gl_Position = u_proj * u_view * round(final_pos);
+    }
+)";
+
+const char * const text_frag_shader_str = R"(
+    #version 450
+
+    layout(location = 10) uniform sampler2DArray texsamplerarray;
+    layout(location = 11) uniform uvec3 texarraydims;
+
+    in vec4 f_color;
+    in vec3 f_texcoords;
+
+    out vec4 fragcolor;
+
+    void main() {
+        // normalize "raw" texture coordinates with full texture size
+        vec4 texel = texture(texsamplerarray, f_texcoords / vec3(texarraydims.xy, 1));
+
+        if (texel.xyz == vec3(255.0 / 255.0, 0.0, 128.0 / 255.0))
+            discard;
+
+        fragcolor = texel * f_color;
+    }
+)";
+
+// layout of a font in shader storage (std430), matching Font in the vertex shader
+struct FontData {
+    GLint tex[4];
+    GLint glyph[4];
+    GLint spacing[4];
+};
+
+// number of glyphs packed into a word of glyph storage
+#define TEXTENV_GLYPHS_PER_WORD 4
+
+void TextEnv::_bindAttribs() {
+    _stage.bindBufferToIndex(_pos.handle(), 1, 0, sizeof(glm::vec3));
+    _stage.bindBufferToIndex(_scale.handle(), 2, 0, sizeof(glm::vec3));
+    _stage.bindBufferToIndex(_color.handle(), 3, 0, sizeof(glm::vec4));
+    _stage.bindBufferToIndex(_text.handle(), 4, 0, sizeof(glm::uvec4));
+}
+
+unsigned TextEnv::_string(unsigned offset) {
+    if (offset >= _string_offsets.size())
+        throw std::out_of_range("Index out of range");
+    if (!_string_offsets.at(offset))
+        throw InactiveIntException();
+    return offset;
+}
+
+void TextEnv::_reserveWords(unsigned offset, unsigned words) {
+    if (words <= _string_words[offset])
+        return;
+
+    // double the reserved words until they fit, and move the glyphs into them
+    unsigned reserved = std::max(_string_words[offset], 1u);
+    while (reserved < words)
+        reserved *= 2;
+    unsigned first = _glyph_words.pushRange(reserved);
+    glm::uvec4 text = _text.get(offset);
+    if (_string_words[offset])
+        _glyph_words.removeRange(text.y, _string_words[offset]);
+
+    // grow glyph storage if the range is past its end, copying the words in use on the GPU
+    if (_glyph_words.size() > _glyph_capacity) {
+        unsigned capacity = std::max(_glyph_capacity, 1u);
+        while (capacity < _glyph_words.size())
+            capacity *= 2;
+        _glyphs.resize(capacity, _glyph_capacity);
+        _glyph_capacity = capacity;
+    }
+
+    for (unsigned i = 0; i < _string_words[offset]; i++)
+        _glyphs.set(first + i, _glyphs.get(text.y + i));
+    for (unsigned i = 0; i < reserved; i++)
+        _glyphs.mark(first + i);
+    _string_words[offset] = reserved;
+    _text.set(offset, glm::uvec4(text.x, first, text.z, 0u));
+}
+
+void TextEnv::_setGlyph(unsigned offset, unsigned index, unsigned char glyph) {
+    unsigned word = _text.get(offset).y + (index / TEXTENV_GLYPHS_PER_WORD);
+    unsigned shift = 8 * (index % TEXTENV_GLYPHS_PER_WORD);
+    GLuint value = (_glyphs.get(word) & ~(0xFFu << shift)) | (GLuint(glyph) << shift);
+    _glyphs.set(word, value);
+}
+
+TextEnv::TextEnv(GLEnv *glenv, unsigned capacity) :
+    _glenv(nullptr), _glyph_capacity(0), _capacity(0), _max_length(0), _initialized(false)
+{
+    init(glenv, capacity);
+}
+TextEnv::TextEnv(TextEnv &&other) { operator=(std::move(other)); }
+TextEnv::TextEnv() : _glenv(nullptr), _glyph_capacity(0), _capacity(0), _max_length(0), _initialized(false) {}
+TextEnv::~TextEnv() {
+    uninit();
+}
+
+TextEnv &TextEnv::operator=(TextEnv &&other) {
+    if (this != &other) {
+        _stage = std::move(other._stage);
+        _glenv = other._glenv;
+        _fonts = std::move(other._fonts);
+        _glb_fonts = std::move(other._glb_fonts);
+        _pos = std::move(other._pos);
+        _scale = std::move(other._scale);
+        _color = std::move(other._color);
+        _text = std::move(other._text);
+        _glyphs = std::move(other._glyphs);
+        _glyph_words = other._glyph_words;
+        _glyph_capacity = other._glyph_capacity;
+        _strings = std::move(other._strings);
+        _string_words = std::move(other._string_words);
+        _string_offsets = other._string_offsets;
+        _capacity = other._capacity;
+        _max_length = other._max_length;
+        _stats = other._stats;
+        _initialized = other._initialized;
+        other._glenv = nullptr;
+        other._glyph_words.clear();
+        other._glyph_capacity = 0;
+        other._string_offsets.clear();
+        other._capacity = 0;
+        other._max_length = 0;
+        other._initialized = false;
+    }
+    return *this;
+}
+
+void TextEnv::init(GLEnv *glenv, unsigned capacity) {
+    if (_initialized)
+        throw InitializedException();
+
+    /* initialize members */
+    _glenv = glenv;
+    _fonts.clear();
+    _pos.init(capacity);
+    _scale.init(capacity);
+    _color.init(capacity);
+    _text.init(capacity);
+    // storage is never empty, as it is bound for drawing even without glyphs
+    _glyphs.init(capacity);
+    _glyph_words.clear();
+    _glyph_capacity = capacity;
+    _strings = std::vector<std::string>(capacity);
+    _string_words = std::vector<unsigned>(capacity, 0);
+    _string_offsets.clear();
+    _capacity = capacity;
+    _max_length = 0;
+    _stats = GLEnvStats{};
+
+    /* set up shader program */
+    const char *shaders[2];
+    shaders[0] = text_vert_shader_str;
+    shaders[1] = text_frag_shader_str;
+    GLenum types[2];
+    types[0] = GL_VERTEX_SHADER;
+    types[1] = GL_FRAGMENT_SHADER;
+    _stage.init(shaders, types, 2);
+
+    // set format of per string attributes (characters have no vertex attributes, and are expanded from gl_VertexID)
+    _stage.setAttribFormat(1, 3, GL_FLOAT, 0, 1);
+    _stage.setAttribFormat(2, 3, GL_FLOAT, 0, 1);
+    _stage.setAttribFormat(3, 4, GL_FLOAT, 0, 1);
+    _stage.setAttribIFormat(4, 4, GL_UNSIGNED_INT, 0, 1);
+    for (unsigned i = 1; i <= 4; i++)
+        _stage.setAttribBufferIndex(i, i);
+    _bindAttribs();
+
+    _initialized = true;
+}
+
+void TextEnv::uninit() {
+    if (!_initialized)
+        return;
+
+    _stage.uninit();
+    _glenv = nullptr;
+    _fonts.clear();
+    _glb_fonts.uninit();
+    _pos.uninit();
+    _scale.uninit();
+    _color.uninit();
+    _text.uninit();
+    _glyphs.uninit();
+    _glyph_words.clear();
+    _glyph_capacity = 0;
+    _strings.clear();
+    _string_words.clear();
+    _string_offsets.clear();
+    _capacity = 0;
+    _max_length = 0;
+    _initialized = false;
+}
+
+unsigned TextEnv::addFont(TextConfig config) {
+    _fonts.push_back(config);
+
+    // rewrite every font (fonts are few, and rarely added)
+    std::vector<FontData> fonts;
+    for (TextConfig &font : _fonts)
+        fonts.push_back(FontData{
+            { font.tex_x, font.tex_y, font.tex_z, font.tex_columns },
+            { font.text_width, font.text_height, font.text_xoff, font.text_yoff },
+            { font.spacing, font.tex_rows, 0, 0 }
+        });
+    _glb_fonts.uninit();
+    _glb_fonts.init(GL_STATIC_DRAW, fonts.size() * sizeof(FontData));
+    _glb_fonts.subData(fonts.size() * sizeof(FontData), fonts.data(), 0);
+
+    return _fonts.size() - 1;
+}
+
+unsigned TextEnv::genText(unsigned font) {
+    if (font >= _fonts.size())
+        throw std::out_of_range("Index out of range");
+
+    unsigned offset = _string_offsets.push();
+    if (offset >= _capacity) {
+        // double the capacity, copying the strings on the GPU
+        unsigned capacity = std::max(_capacity * 2, 1u);
+        _pos.resize(capacity, _capacity);
+        _scale.resize(capacity, _capacity);
+        _color.resize(capacity, _capacity);
+        _text.resize(capacity, _capacity);
+        _strings.resize(capacity);
+        _string_words.resize(capacity, 0);
+        _capacity = capacity;
+        _bindAttribs();
+    }
+
+    _strings[offset].clear();
+    _string_words[offset] = 0;
+    _pos.set(offset, glm::vec3(0.0f));
+    _pos.mark(offset);
+    _scale.set(offset, glm::vec3(1.0f));
+    _scale.mark(offset);
+    _color.set(offset, glm::vec4(1.0f));
+    _color.mark(offset);
+    _text.set(offset, glm::uvec4(font, 0u, 0u, 0u));
+    _text.mark(offset);
+    return offset;
+}
+
+void TextEnv::remove(unsigned offset) {
+    _string(offset);
+    _string_offsets.remove(offset);
+
+    // free the glyphs, and draw nothing for the offset until reused
+    glm::uvec4 text = _text.get(offset);
+    if (_string_words[offset])
+        _glyph_words.removeRange(text.y, _string_words[offset]);
+    _string_words[offset] = 0;
+    _strings[offset].clear();
+    _text.set(offset, glm::uvec4(text.x, 0u, 0u, 0u));
+}
+
+void TextEnv::setText(unsigned offset, const char *str) {
+    std::string &current = _strings[_string(offset)];
+    if (current == str)
+        return;
+
+    unsigned length = std::strlen(str);
+    _reserveWords(offset, (length + TEXTENV_GLYPHS_PER_WORD - 1) / TEXTENV_GLYPHS_PER_WORD);
+
+    // write only the characters that differ
+    for (unsigned i = 0; i < length; i++)
+        if (i >= current.size() || current[i] != str[i])
+            _setGlyph(offset, i, (unsigned char)str[i]);
+    current = str;
+
+    glm::uvec4 text = _text.get(offset);
+    _text.set(offset, glm::uvec4(text.x, text.y, length, 0u));
+}
+
+void TextEnv::setPos(unsigned offset, glm::vec3 pos) { _pos.set(_string(offset), pos); }
+
+void TextEnv::setScale(unsigned offset, glm::vec3 scale) { _scale.set(_string(offset), scale); }
+
+void TextEnv::setColor(unsigned offset, glm::vec4 color) { _color.set(_string(offset), color); }
+
+void TextEnv::setFont(unsigned offset, unsigned font) {
+    if (font >= _fonts.size())
+        throw std::out_of_range("Index out of range");
+    glm::uvec4 text = _text.get(_string(offset));
+    _text.set(offset, glm::uvec4(font, text.y, text.z, 0u));
+}
+
+const std::string &TextEnv::getText(unsigned offset) { return _strings[_string(offset)]; }
+
+void TextEnv::setView(glm::mat4 view) {
+    _stage.uniformmat4f(8, view);
+}
+
+void TextEnv::setProj(glm::mat4 proj) {
+    _stage.uniformmat4f(9, proj);
+}
+
+void TextEnv::update() {
+    _stats = GLEnvStats{};
+    unsigned count = _string_offsets.size();
+    _pos.upload(count, _stats);
+    _scale.upload(count, _stats);
+    _color.upload(count, _stats);
+    _text.upload(count, _stats);
+    _glyphs.upload(_glyph_words.size(), _stats);
+
+    _max_length = 0;
+    for (unsigned i = 0; i < count; i++)
+        _max_length = std::max(_max_length, unsigned(_strings[i].size()));
+}
+
+void TextEnv::drawText() {
+    if (_max_length == 0 || _fonts.empty())
+        return;
+
+    // bind program, storage and the environment's texture array, in case others were bound since
+    _stage.use();
+    GLUtil::GLTexture2DArray &texarray = _glenv->getTexArray();
+    texarray.bind(GL_TEXTURE_2D_ARRAY);
+    _stage.uniform3ui(11, glm::uvec3(texarray.width(), texarray.height(), texarray.depth()));
+    _glb_fonts.bindBase(GL_SHADER_STORAGE_BUFFER, 2);
+    _glyphs.bindBase(GL_SHADER_STORAGE_BUFFER, 3);
+
+    // draw one instance per string, with enough vertices for the longest
+    GLUtil::renderInst(GL_TRIANGLES, 6 * _max_length, _string_offsets.size(), false);
+}
+
+bool TextEnv::hasOffset(unsigned offset) { return offset < _string_offsets.size() && _string_offsets.at(offset); }
+
+bool TextEnv::getInitialized() { return _initialized; }
+
+GLEnvStats TextEnv::getStats() { return _stats; }
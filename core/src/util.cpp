@@ -12,30 +12,62 @@ std::string readfile(const char *filename) {
     return buf.str();
 }
 
-Image::Image(const char *filename) {
+Image::Image(const char *filename) : _data(NULL), _w(0), _h(0), _components(0), _size(0) {
     load(filename);
 }
-Image::Image(const Image &other) :
-    _data(other.copyData()),
-    _w(other._w),
-    _h(other._h),
-    _components(other._components),
-    _size(other._size)
-{}
-Image::Image() : _data(NULL), _w(0), _h(0), _size(0) {};
+Image::Image(const Image &other) : _data(NULL), _w(0), _h(0), _components(0), _size(0) {
+    operator=(other);
+}
+Image::Image(Image &&other) : _data(NULL), _w(0), _h(0), _components(0), _size(0) {
+    operator=(std::move(other));
+}
+Image::Image() : _data(NULL), _w(0), _h(0), _components(0), _size(0) {};
 Image& Image::operator=(const Image &other) {
-    _data = other.copyData();
-    _w = other._w;
-    _h = other._h;
-    _components = other._components;
-    _size = other._size;
+    if (this != &other) {
+        if (_data)
+            free();
+
+        // allocate with malloc, as held data is released by stbi_image_free()
+        if (other._data) {
+            _data = (unsigned char*)malloc(other._size);
+            if (!_data)
+                throw std::bad_alloc();
+            memcpy(_data, other._data, other._size);
+        }
+        _w = other._w;
+        _h = other._h;
+        _components = other._components;
+        _size = other._size;
+    }
+    return *this;
+}
+Image& Image::operator=(Image &&other) {
+    if (this != &other) {
+        if (_data)
+            free();
+
+        _data = other._data;
+        _w = other._w;
+        _h = other._h;
+        _components = other._components;
+        _size = other._size;
+        other._data = NULL;
+        other._w = 0;
+        other._h = 0;
+        other._components = 0;
+        other._size = 0;
+    }
     return *this;
 }
 Image::~Image() {
-    free();
+    if (_data)
+        free();
 }
 
 void Image::load(const char *filename) {
+    if (_data)
+        free();
+
     _data = stbi_load(filename, &_w, &_h, &_components, 4);
     
     if (!_data)
@@ -56,15 +88,16 @@ unsigned char* Image::copyData() const {
     if (!_data)
         throw std::runtime_error("Attempt to copy Image with null data");
     
-    char *copy = new char[_size];
+    unsigned char *copy = new unsigned char[_size];
     return (unsigned char*)memcpy((void*)copy, (void*)_data, _size * sizeof(unsigned char));
 }
 
-int Image::width() { return _w; }
-int Image::height() { return _h; }
-int Image::components() { return _components; }
-int Image::size() { return _size; }
-bool Image::empty() { return (_data == NULL); }
+const unsigned char* Image::data() const { return _data; }
+int Image::width() const { return _w; }
+int Image::height() const { return _h; }
+int Image::components() const { return _components; }
+int Image::size() const { return _size; }
+bool Image::empty() const { return (_data == NULL); }
 
 IntGenerator::IntGenerator() {}
 IntGenerator::~IntGenerator() { /* automatic destruction is fine */ }
@@ -111,6 +144,98 @@ unsigned IntGenerator::size() { return _ids.size(); }
 unsigned IntGenerator::freeSize() { return _free_ids.size(); }
 unsigned IntGenerator::activeSize() { return _ids.size() - _free_ids.size(); }
 
+RangeGenerator::RangeGenerator() : _free_count(0) {}
+RangeGenerator::~RangeGenerator() { /* automatic destruction is fine */ }
+
+unsigned RangeGenerator::push() {
+    return pushRange(1);
+}
+
+unsigned RangeGenerator::pushRange(unsigned count) {
+    if (count == 0)
+        throw std::runtime_error("Attempt to push empty range of IDs");
+
+    unsigned first = _ids.size();
+    for (auto it = _free_ranges.begin(); it != _free_ranges.end(); it++) {
+        if (it->second >= count) {
+            // take the start of the range, and keep its remainder free
+            first = it->first;
+            if (it->second > count)
+                _free_ranges[first + count] = it->second - count;
+            _free_ranges.erase(it);
+            _free_count -= count;
+            break;
+        }
+
+        // extend the free range at the end past it, if none fits
+        if (it->first + it->second == _ids.size()) {
+            first = it->first;
+            _free_count -= it->second;
+            _free_ranges.erase(it);
+            break;
+        }
+    }
+
+    if (first + count > _ids.size())
+        _ids.resize(first + count, false);
+    for (unsigned i = first; i < first + count; i++)
+        _ids[i] = true;
+    return first;
+}
+
+void RangeGenerator::remove(unsigned i) {
+    removeRange(i, 1);
+}
+
+void RangeGenerator::removeRange(unsigned first, unsigned count) {
+    if (count == 0)
+        throw std::runtime_error("Attempt to remove empty range of IDs");
+    for (unsigned i = first; i < first + count; i++)
+        if (i >= _ids.size() || !_ids[i])
+            throw InactiveIntException();
+    for (unsigned i = first; i < first + count; i++)
+        _ids[i] = false;
+    _free_count += count;
+
+    // merge with the free ranges directly after and before it
+    auto next = _free_ranges.find(first + count);
+    if (next != _free_ranges.end()) {
+        count += next->second;
+        _free_ranges.erase(next);
+    }
+    auto it = _free_ranges.lower_bound(first);
+    if (it != _free_ranges.begin()) {
+        auto prev = std::prev(it);
+        if (prev->first + prev->second == first) {
+            prev->second += count;
+            return;
+        }
+    }
+    _free_ranges[first] = count;
+}
+
+std::vector<unsigned> RangeGenerator::getUsed() {
+    std::vector<unsigned> indices;
+    for (unsigned i = 0; i < _ids.size(); i++)
+        if (_ids[i])
+            indices.push_back(i);
+    
+    return indices;
+}
+
+void RangeGenerator::clear() {
+    _ids.clear();
+    _free_ranges.clear();
+    _free_count = 0;
+}
+
+bool RangeGenerator::at(unsigned i) { return _ids[i]; }
+bool RangeGenerator::operator[](unsigned i) { return _ids[i]; }
+bool RangeGenerator::empty() { return (_ids.size() == 0); }
+unsigned RangeGenerator::size() { return _ids.size(); }
+unsigned RangeGenerator::freeSize() { return _free_count; }
+unsigned RangeGenerator::activeSize() { return _ids.size() - _free_count; }
+
 bool endsWith(const std::string& str, const std::string& suffix)
 {
     return str.size() >= suffix.size() && 0 == str.compare(str.size()-suffix.size(), suffix.size(), suffix);
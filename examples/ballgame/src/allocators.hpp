@@ -1,62 +1,83 @@
 #include "implementations.hpp"
 
-class ShrinkParticleAllocator : public ProvidedEntityAllocator<ShrinkParticle> { ShrinkParticle *_allocateProvided() override { return new ShrinkParticle; } };
+// allocators draw instances from per-type SlabPools, so that spawning and killing Entities does not allocate
+
+class ShrinkParticleAllocator : public ProvidedEntityAllocator<ShrinkParticle> {
+    SlabPool<ShrinkParticle> _pool;
+    ShrinkParticle *_allocateProvided() override { return _pool.alloc(); }
+    void _deallocateProvided(ShrinkParticle *s) override { _pool.free(s); }
+};
 
 class BulletAllocator : public ProvidedEntityAllocator<Bullet> {
+    SlabPool<Bullet> _pool;
+    const EntityTypes *_types;
     Provider<ShrinkParticle> *_shrinkparticle_provider;
     Bullet *_allocateProvided() override {
-        Bullet *b = new Bullet;
+        Bullet *b = _pool.alloc(_types);
         _shrinkparticle_provider->subscribe(b);
         return b;
     }
+    void _deallocateProvided(Bullet *b) override { _pool.free(b); }
 public:
-    BulletAllocator(Provider<ShrinkParticle> *shrinkparticle_provider) : _shrinkparticle_provider(shrinkparticle_provider) {}
+    BulletAllocator(const EntityTypes *types, Provider<ShrinkParticle> *shrinkparticle_provider) : _types(types), _shrinkparticle_provider(shrinkparticle_provider) {}
 };
 
 class PlayerAllocator : public ProvidedEntityAllocator<Player> {
+    SlabPool<Player> _pool;
     GLFWInput *_input;
+    const EntityTypes *_types;
     Provider<Bullet> *_bullet_provider;
     Provider<ShrinkParticle> *_shrinkparticle_provider;
     Player *_allocateProvided() override {
-        Player *p = new Player(_input);
+        Player *p = _pool.alloc(_input, _types);
         _bullet_provider->subscribe(p);
         _shrinkparticle_provider->subscribe(p);
         return p;
     }
+    void _deallocateProvided(Player *p) override { _pool.free(p); }
 public:
-    PlayerAllocator(GLFWInput *input, Provider<Bullet> *bullet_provider, Provider<ShrinkParticle> *shrinkparticle_provider) : 
+    PlayerAllocator(GLFWInput *input, const EntityTypes *types, Provider<Bullet> *bullet_provider, Provider<ShrinkParticle> *shrinkparticle_provider) : 
+        _pool(1),
         _input(input), 
+        _types(types),
         _bullet_provider(bullet_provider),
         _shrinkparticle_provider(shrinkparticle_provider)
     {}
 };
 
 class EnemyAllocator : public ProvidedEntityAllocator<Enemy> {
+    SlabPool<Enemy> _pool;
     Provider<Player> *_player_provider;
     Provider<ShrinkParticle> *_shrinkparticle_provider;
 
     bool *_killflag;
+    const EntityTypes *_types;
     Enemy *_allocateProvided() override { 
-        Enemy *e = new Enemy(_killflag); 
+        Enemy *e = _pool.alloc(_killflag, _types); 
         _player_provider->subscribe(e);
         _shrinkparticle_provider->subscribe(e);
         return e;
     }
+    void _deallocateProvided(Enemy *e) override { _pool.free(e); }
 public:
-    EnemyAllocator(Provider<Player> *player_provider, Provider<ShrinkParticle> *shrinkparticle_provider, bool *killflag) : 
+    EnemyAllocator(Provider<Player> *player_provider, Provider<ShrinkParticle> *shrinkparticle_provider, bool *killflag, const EntityTypes *types) : 
+        _pool(16),
         _player_provider(player_provider), 
         _shrinkparticle_provider(shrinkparticle_provider),
-        _killflag(killflag) 
+        _killflag(killflag),
+        _types(types)
     {}
 };
 
 class RingAllocator : public EntityAllocatorInterface {
+    SlabPool<Ring> _pool;
     Provider<Player> *_player_provider;
     Ring *_allocate(int tag) override {
-        Ring *r = new Ring;
+        Ring *r = _pool.alloc();
         _player_provider->subscribe(r);
         return r;
     }
+    void _deallocate(Script *script) override { _pool.free(static_cast<Ring*>(script)); }
 public:
-    RingAllocator(Provider<Player> *player_provider) : _player_provider(player_provider) {}
+    RingAllocator(Provider<Player> *player_provider) : _pool(1), _player_provider(player_provider) {}
 };
\ No newline at end of file
@@ -2,8 +2,10 @@
 
 const char *ANIMATION_DIR = "./animconfig";
 const char *FILTER_DIR = "./filterconfig";
+const char *PROGRAM_CACHE_DIR = "./programcache";
 
-const unsigned MAX_COUNT = 2048;
+const unsigned INITIAL_QUAD_CAPACITY = 256;
+const unsigned INITIAL_TEXT_CAPACITY = 4;
 const unsigned EXECUTION_QUEUES = 2;
 
 const unsigned WINDOW_WIDTH = 512;
@@ -12,13 +14,23 @@ const unsigned PIXEL_WIDTH = WINDOW_WIDTH / 2;
 const unsigned PIXEL_HEIGHT = WINDOW_HEIGHT / 2;
 const unsigned PIXEL_LEVELS = 16;
 
-const unsigned TEX_SPACE_WIDTH = 133;
-const unsigned TEX_SPACE_HEIGHT = 318;
+// texture sheets, one per texture space layer (texture values in animation configurations refer to these layers)
 const unsigned TEX_SPACE_LEVELS = 4;
+const char *TEX_SHEETS[TEX_SPACE_LEVELS] = {
+    "gfx/objects.png",
+    "gfx/effects.png",
+    "gfx/characters1.png", // each character is 7x24 pixels
+    "gfx/characters2.png" // each character is 5x10 pixels
+};
 
 const float CLEAR_COLOR_GRAY = 0.35f;
 
 void initializeCore(CoreResources *core) {
+    // decode texture sheets in the background while the context and other resources are set up
+    std::cout << "Decoding texture sheets" << std::endl;
+    ImageLoader sheets;
+    sheets.start(std::vector<std::string>(TEX_SHEETS, TEX_SHEETS + TEX_SPACE_LEVELS), 0);
+
     // initialize GLFW, OpenGL, and GLFWInput
     std::cout << "Setting up GLFWState" << std::endl;
     core->state.init(WINDOW_WIDTH, WINDOW_HEIGHT, "title", true);
@@ -36,12 +48,23 @@ void initializeCore(CoreResources *core) {
 
     // set up GLEnv
     std::cout << "Setting up GLEnv" << std::endl;
-    core->glenv.init(MAX_COUNT);
-    core->glenv.setTexArray(TEX_SPACE_WIDTH, TEX_SPACE_HEIGHT, TEX_SPACE_LEVELS);
-    core->glenv.setTexture(Image("gfx/objects.png"), 0, 0, 0);
-    core->glenv.setTexture(Image("gfx/effects.png"), 0, 0, 1);
-    core->glenv.setTexture(Image("gfx/characters1.png"), 0, 0, 2); // each character is 7x24 pixels
-    core->glenv.setTexture(Image("gfx/characters2.png"), 0, 0, 3); // each character is 5x10 pixels
+    GLUtil::setProgramCacheDir(PROGRAM_CACHE_DIR);
+    core->glenv.init(INITIAL_QUAD_CAPACITY, GLE_PERSISTENT | GLE_SHRINK | GLE_PACKED | GLE_OFFSCREEN | GLE_GPU_ANIM);
+    core->glenv.setAnimations(core->animations);
+
+    // size texture space to fit the largest sheet, and upload the sheets once decoded
+    sheets.wait();
+    unsigned tex_space_width = 0;
+    unsigned tex_space_height = 0;
+    for (unsigned i = 0; i < TEX_SPACE_LEVELS; i++) {
+        tex_space_width = std::max(tex_space_width, unsigned(sheets.image(i).width()));
+        tex_space_height = std::max(tex_space_height, unsigned(sheets.image(i).height()));
+    }
+    core->glenv.setTexArray(tex_space_width, tex_space_height, TEX_SPACE_LEVELS);
+    sheets.upload([core](unsigned i, const Image &img) {
+        core->glenv.setTexture(img, 0, 0, i);
+    });
+    sheets.printTimings(std::cout);
     
     float halfwidth = float(PIXEL_WIDTH) / 2.0f;
     float halfheight = float(PIXEL_HEIGHT) / 2.0f;
@@ -50,6 +73,12 @@ void initializeCore(CoreResources *core) {
     core->glenv.setWindowSpace(WINDOW_WIDTH, WINDOW_HEIGHT);
     core->glenv.setPixelSpace(PIXEL_WIDTH, PIXEL_HEIGHT, PIXEL_LEVELS);
 
+    // set up TextEnv, textured from the GLEnv's sheets and sharing its pixel space
+    std::cout << "Setting up TextEnv" << std::endl;
+    core->textenv.init(&core->glenv, INITIAL_TEXT_CAPACITY);
+    core->textenv.setView(glm::lookAt(glm::vec3(0.0f, 0.0f, 1.0f), glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3(0.0f, 1.0f, 0.0f)));
+    core->textenv.setProj(glm::ortho(-1.0f * halfwidth, halfwidth, -1.0f * halfheight, halfheight, 0.0f, float(PIXEL_LEVELS)));
+
     // set up Executor
     std::cout << "Setting up Executor" << std::endl;
     core->executor.init(EXECUTION_QUEUES, &core->glenv, &core->animations, &core->box_space, &core->sphere_space, &core->filters);
@@ -3,11 +3,14 @@
 
 #include "implementations.hpp"
 #include "../../../core/include/glfwstate.hpp"
+#include "../../../core/include/imageloader.hpp"
+#include "../../../core/include/textenv.hpp"
 
 struct CoreResources {
     GLFWState state;
     GLFWInput input;
     GLEnv glenv;
+    TextEnv textenv;
     unordered_map_string_Animation_t animations;
     unordered_map_string_Filter_t filters;
     PhysSpace<Box> box_space;
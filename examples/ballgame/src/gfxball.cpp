@@ -1,9 +1,15 @@
 #include "gfxball.hpp"
 
 void GfxBall::_initEntity() {
-    // create and set quad
-    _quad_off = executor().glenv().genQuad(transform.pos, transform.scale, glm::vec4(1.0f), glm::vec3(0.0f), glm::vec2(0.0f), GLE_ELLIPSE);
-    _quad = executor().glenv().getQuad(_quad_off);
+    // create and set quad, or set the one kept from a previous spawn if recycled
+    if (!_quad) {
+        _quad_off = executor().glenv().genQuad(transform.pos, transform.scale, glm::vec4(1.0f), glm::vec3(0.0f), glm::vec2(0.0f), GLE_ELLIPSE);
+        _quad = executor().glenv().getQuad(_quad_off);
+    } else {
+        _quad->setPos(transform.pos);
+        _quad->setScale(transform.scale);
+        _quad->setColor(glm::vec4(1.0f));
+    }
 
     // set animation if it is named
     if (_animation_name != "")
@@ -17,8 +23,8 @@ void GfxBall::_baseEntity() {
     _baseGfxBall();
 
     // update quad to match Script transform (except for z-coordinate), and step animation
-    _quad->bv_pos.v = glm::vec3(transform.pos.x, transform.pos.y, _quad->bv_pos.v.z);
-    _quad->bv_scale.v = transform.scale;
+    _quad->setPos(glm::vec3(transform.pos.x, transform.pos.y, _quad->getPos().z));
+    _quad->setScale(transform.scale);
 
     _quad->stepAnim();
 
@@ -28,20 +34,40 @@ void GfxBall::_baseEntity() {
             enqueueKill();
     }
 
-    // only queue if not set to be killed
-    if (!getKillEnqueued())
+    // only queue if not set to be killed, and not already run every execution
+    if (!getKillEnqueued() && !getPersistent())
         enqueueExec(getLastExecQueue());
 }
 
 void GfxBall::_killEntity() {
-    executor().glenv().remove(_quad_off);
+    // keep quad for the next spawn if recycled, hiding it (animations would override the scale)
+    if (getRecycle()) {
+        _quad->setAnim(nullptr);
+        _quad->setScale(glm::vec3(0.0f));
+    } else
+        executor().glenv().remove(_quad_off);
 
     _killGfxBall();
 }
 
+void GfxBall::_resetEntity() {
+    _i = 0;
+
+    _resetGfxBall();
+}
+
+void GfxBall::_releaseEntity() {
+    // release the quad kept while recycled (if it was killed before being initialized, there is none)
+    if (!_quad)
+        return;
+    executor().glenv().remove(_quad_off);
+    _quad = nullptr;
+}
+
 void GfxBall::_initGfxBall() {}
 void GfxBall::_baseGfxBall() {}
 void GfxBall::_killGfxBall() {}
+void GfxBall::_resetGfxBall() {}
 
 GfxBall::GfxBall(std::string animation_name, int lifetime) : 
     Entity(), 
@@ -11,6 +11,8 @@ class GfxBall : public Entity {
     void _initEntity() override;
     void _baseEntity() override;
     void _killEntity() override;
+    void _resetEntity() override;
+    void _releaseEntity() override;
 
 protected:
     int _lifetime;
@@ -19,6 +21,7 @@ protected:
     virtual void _initGfxBall();
     virtual void _baseGfxBall();
     virtual void _killGfxBall();
+    virtual void _resetGfxBall();
 
 public:
     /* If lifetime is negative, this effect does not kill itself. */
@@ -5,7 +5,7 @@ void Bullet::_initPhysBall() {
     vel = _direction;
 
     // display on level with other entities
-    quad()->bv_pos.v.z = 0.0f;
+    quad()->setPos(glm::vec3(transform.pos.x, transform.pos.y, 0.0f));
 
     // override transform scale
     transform = Transform{transform.pos, glm::vec3(6.0f, 6.0f, 0.0f)};
@@ -18,11 +18,11 @@ void Bullet::_basePhysBall() {
     _i++;
 
     if (_i % 6 == 0)
-        executor().enqueueSpawnEntity("ShrinkParticle", 1, getExecutorID(), transform);
+        executor().enqueueSpawnEntity(_types->shrinkparticle, 1, getExecutorID(), transform);
 
     if (_i >= _lifetime || sphere()->getCollidedCount()) {
         enqueueKill();
-        executor().enqueueSpawnEntity("ShrinkParticle", 1, getExecutorID(), transform);
+        executor().enqueueSpawnEntity(_types->shrinkparticle, 1, getExecutorID(), transform);
     }
 }
 
@@ -31,6 +31,11 @@ void Bullet::_killPhysBall() {
     removeFromProvider();
 }
 
+void Bullet::_resetPhysBall() {
+    _i = 0;
+    _direction = glm::vec3(0.0f);
+}
+
 void Bullet::_receive(ShrinkParticle *p) {
     if (!getKillEnqueued())
         p->set(glm::vec3(4.0f), glm::vec4(1.0f), 24, glm::vec3(0.0f));
@@ -38,7 +43,7 @@ void Bullet::_receive(ShrinkParticle *p) {
         p->set(transform.scale, glm::vec4(1.0f), 24, _direction / 4.0f);
 };
 
-Bullet::Bullet() : PhysBall("", "Bullet"), _i(0), _lifetime(119), _direction(0.0f) {}
+Bullet::Bullet(const EntityTypes *types) : PhysBall("", "Bullet"), _types(types), _i(0), _lifetime(119), _direction(0.0f) {}
 
 void Bullet::setDirection(glm::vec3 direction) { _direction = direction; }
 
@@ -51,7 +56,7 @@ void Player::_initPhysBall() {
     Receiver<ShrinkParticle>::enableReception(true);
 
     // display on level with other entities
-    quad()->bv_pos.v.z = 0.0f;
+    quad()->setPos(glm::vec3(transform.pos.x, transform.pos.y, 0.0f));
     
     // override transform scale
     transform = Transform{transform.pos, glm::vec3(12.0f, 12.0f, 0.0f)};
@@ -83,9 +88,10 @@ void Player::_receive(ShrinkParticle *particle) {
     }
 }
 
-Player::Player(GLFWInput *input) : 
+Player::Player(GLFWInput *input, const EntityTypes *types) : 
     PhysBall("", "Player"),
     _input(input),
+    _types(types),
     _accel(0.2f), 
     _deccel(0.15f), 
     _spd_max(0.8f), 
@@ -142,7 +148,7 @@ void Player::playerAction() {
     if (_cooldown <= 0.0f) {
         if (_input->get_m1() || _input->get_space()) {
             // spawn projectile and set cooldown
-            executor().enqueueSpawnEntity("Bullet", 0, getExecutorID(), transform);
+            executor().enqueueSpawnEntity(_types->bullet, 0, getExecutorID(), transform);
             _cooldown = _max_cooldown;
         }
     } else
@@ -158,7 +164,7 @@ void Player::playerDeath() {
         angle = glm::rotate(angle, glm::radians(360.0f / float(count)), glm::vec3(0.0f, 0.0f, 1.0f));
 
         // enqueue particle and store angle
-        executor().enqueueSpawnEntity("ShrinkParticle", 1, getExecutorID(), transform);
+        executor().enqueueSpawnEntity(_types->shrinkparticle, 1, getExecutorID(), transform);
         _deathparticledirs.push(angle);
     }
 }
@@ -167,8 +173,8 @@ void Player::playerDeath() {
 
 void Enemy::_initPhysBall() {
     // display on level with other entities
-    quad()->bv_pos.v.z = 0.0f;
-    quad()->bv_color.v = glm::vec4(0.2116f, 0.2116f, 0.2166f, 1.0f);
+    quad()->setPos(glm::vec3(transform.pos.x, transform.pos.y, 0.0f));
+    quad()->setColor(glm::vec4(0.2116f, 0.2116f, 0.2166f, 1.0f));
 
     Receiver<ShrinkParticle>::setChannel(getExecutorID());
     Receiver<ShrinkParticle>::enableReception(true);
@@ -218,7 +224,7 @@ Entity *Enemy::_getTarget() {
     return nullptr;
 }
 
-Enemy::Enemy(bool *killflag) :
+Enemy::Enemy(bool *killflag, const EntityTypes *types) :
     PhysBall("", "Enemy"),
     _accel(0.075f), 
     _deccel(0.05f), 
@@ -226,7 +232,8 @@ Enemy::Enemy(bool *killflag) :
     _t(rand() % 256), 
     _prevdir(0.0f),
     _health(1.0f),
-    _killflag(killflag)
+    _killflag(killflag),
+    _types(types)
 {}
 
 void Enemy::enemyMotion() {
@@ -285,7 +292,7 @@ void Enemy::enemyCollision() {
             angle = glm::rotate(angle, glm::radians(360.0f / float(count)), glm::vec3(0.0f, 0.0f, 1.0f));
 
             // enqueue particle and store angle
-            executor().enqueueSpawnEntity("ShrinkParticle", 1, getExecutorID(), transform);
+            executor().enqueueSpawnEntity(_types->shrinkparticle, 1, getExecutorID(), transform);
             _deathparticledirs.push(angle);
         }
     }
@@ -300,7 +307,7 @@ void Enemy::enemyDeath() {
         angle = glm::rotate(angle, glm::radians(360.0f / float(count)), glm::vec3(0.0f, 0.0f, 1.0f));
 
         // enqueue particle and store angle
-        executor().enqueueSpawnEntity("ShrinkParticle", 1, getExecutorID(), transform);
+        executor().enqueueSpawnEntity(_types->shrinkparticle, 1, getExecutorID(), transform);
         _deathparticledirs.push(angle);
     }
 }
@@ -311,14 +318,14 @@ void Enemy::setHealth(float health) { _health = health; }
 
 void Ring::_initGfxBall() {
     // display beneath other entities
-    quad()->bv_pos.v.z = -1.0f;
+    quad()->setPos(glm::vec3(transform.pos.x, transform.pos.y, -1.0f));
 
     // override transform scale
     transform = Transform{transform.pos, glm::vec3(128.0f, 128.0f, 0.0f)};
 }
 
 void Ring::_baseGfxBall() {
-    quad()->bv_color.v = glm::vec4(0.4941f, 0.4941f, 0.4941f, 1.0f);
+    quad()->setColor(glm::vec4(0.4941f, 0.4941f, 0.4941f, 1.0f));
 
     // get first player found
     Player *p = nullptr;
@@ -333,7 +340,7 @@ void Ring::_baseGfxBall() {
     // check player's distance from this instance's center
     if (p)
         if (glm::length(p->transform.pos - transform.pos) < 64.0f)
-            quad()->bv_color.v = glm::vec4(0.6039f, 0.6039f, 0.6039f, 1.0f);
+            quad()->setColor(glm::vec4(0.6039f, 0.6039f, 0.6039f, 1.0f));
 }
 
 void Ring::_killGfxBall() {}
@@ -344,8 +351,8 @@ Ring::Ring() : GfxBall("", -1) {}
 
 void ShrinkParticle::_initGfxBall() {
     // display on level with other entities
-    quad()->bv_pos.v.z = 0.0f;
-    quad()->bv_color.v = _color;
+    quad()->setPos(glm::vec3(transform.pos.x, transform.pos.y, 0.0f));
+    quad()->setColor(_color);
 }
 
 void ShrinkParticle::_baseGfxBall() {
@@ -358,6 +365,13 @@ void ShrinkParticle::_killGfxBall() {
     removeFromProvider();
 }
 
+void ShrinkParticle::_resetGfxBall() {
+    _lifetime = 0;
+    _basescale = glm::vec3(0.0f);
+    _color = glm::vec4(0.0f);
+    _vel = glm::vec3(0.0f);
+}
+
 ShrinkParticle::ShrinkParticle() : GfxBall("", 0), _basescale(glm::vec3(0.0f)), _color(glm::vec4(0.0f)), _vel(0.0f) {}
 
 void ShrinkParticle::set(glm::vec3 basescale, glm::vec4 color, unsigned lifetime, glm::vec3 vel) {
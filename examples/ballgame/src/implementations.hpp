@@ -10,9 +10,19 @@ enum Group {
     G_GFXBALL_RING, G_GFXBALL_SHRINKPARTICLE
 };
 
+// handles of the added Entity names, to spawn Entities without looking up their names
+struct EntityTypes {
+    ScriptType bullet;
+    ScriptType player;
+    ScriptType enemy;
+    ScriptType ring;
+    ScriptType shrinkparticle;
+};
+
 class ShrinkParticle;
 
 class Bullet : public PhysBall, public ProvidedType<Bullet>, public Receiver<ShrinkParticle> {
+    const EntityTypes *_types;
     int _i;
     int _lifetime;
     glm::vec3 _direction;
@@ -20,15 +30,17 @@ class Bullet : public PhysBall, public ProvidedType<Bullet>, public Receiver<Shr
     void _initPhysBall() override;
     void _basePhysBall() override;
     void _killPhysBall() override;
+    void _resetPhysBall() override;
     void _receive(ShrinkParticle *p) override;
 
 public:
-    Bullet();
+    Bullet(const EntityTypes *types);
     void setDirection(glm::vec3 direction);
 };
 
 class Player : public PhysBall, public ProvidedType<Player>, public Receiver<Bullet>, public Receiver<ShrinkParticle> {
     GLFWInput *_input;
+    const EntityTypes *_types;
 
     float _accel;
     float _deccel;
@@ -47,7 +59,7 @@ class Player : public PhysBall, public ProvidedType<Player>, public Receiver<Bul
     void _receive(ShrinkParticle *particle) override;
 
 public:
-    Player(GLFWInput *input);
+    Player(GLFWInput *input, const EntityTypes *types);
 
     void playerMotion();
     void playerAction();
@@ -63,6 +75,7 @@ class Enemy : public PhysBall, public ProvidedType<Enemy>, public Receiver<Playe
 
     float _health;
     bool *_killflag;
+    const EntityTypes *_types;
 
     std::queue<glm::vec3> _deathparticledirs;
 
@@ -75,7 +88,7 @@ class Enemy : public PhysBall, public ProvidedType<Enemy>, public Receiver<Playe
     Entity *_getTarget();
 
 public:
-    Enemy(bool *killflag);
+    Enemy(bool *killflag, const EntityTypes *types);
 
     void enemyMotion();
     void enemyCollision();
@@ -100,6 +113,7 @@ class ShrinkParticle : public GfxBall, public ProvidedType<ShrinkParticle> {
     void _initGfxBall() override;
     void _baseGfxBall() override;
     void _killGfxBall() override;
+    void _resetGfxBall() override;
 
 public:
     ShrinkParticle();
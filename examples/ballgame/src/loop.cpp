@@ -1,14 +1,13 @@
 #include "loop.hpp"
 
 Allocators::Allocators(GLFWInput *input, bool *killflag) :
-    Bullet_allocator(&(this->ShrinkParticle_provider)),
-    Player_allocator(input, &(this->Bullet_provider), &(this->ShrinkParticle_provider)),
-    Enemy_allocator(&(this->Player_provider), &(this->ShrinkParticle_provider), killflag),
+    Bullet_allocator(&(this->types), &(this->ShrinkParticle_provider)),
+    Player_allocator(input, &(this->types), &(this->Bullet_provider), &(this->ShrinkParticle_provider)),
+    Enemy_allocator(&(this->Player_provider), &(this->ShrinkParticle_provider), killflag, &(this->types)),
     Ring_allocator(&(this->Player_provider))
 {}
 
-// need this to initialize Text members
-GlobalState::GlobalState(GLEnv *glenv) : toptext(glenv), subtext(glenv), bottomtext(glenv) {
+GlobalState::GlobalState() : toptext(0), subtext(0), bottomtext(0) {
     setChannel(65536);
     enableReception(true);
 }
@@ -25,7 +24,7 @@ void GlobalState::_receive(Enemy *enemy) {
 void loop(CoreResources *core) {
     srand(time(NULL));
 
-    GlobalState globalstate(&core->glenv);
+    GlobalState globalstate;
     Allocators allocators(&core->input, &globalstate.killflag);
     
     // store allocators into providers to intercept their allocations
@@ -46,31 +45,45 @@ void loop(CoreResources *core) {
     };
 
     std::cout << "Ending loop" << std::endl;
+
+    // Entities are released into the allocators' pools, which must still exist
+    core->executor.uninit();
 }
 
 void addAllocators(CoreResources *core, GlobalState *globalstate, Allocators *allocators) {
     // add objects to executor
-    core->executor.addEntity(&allocators->Bullet_allocator, "Bullet", G_PHYSBALL_BULLET, true, nullptr, nullptr);
-    core->executor.addEntity(&allocators->Player_allocator, "Player", G_PHYSBALL_PLAYER, true, nullptr, nullptr);
-    core->executor.addEntity(&allocators->Enemy_allocator, "Enemy", G_PHYSBALL_ENEMY, true, nullptr, nullptr);
-    core->executor.addEntity(&allocators->Ring_allocator, "Ring", G_GFXBALL_RING, true, nullptr, nullptr);
-    core->executor.addEntity(&allocators->ShrinkParticle_allocator, "ShrinkParticle", G_GFXBALL_SHRINKPARTICLE, true, nullptr, nullptr);
+    allocators->types.bullet = core->executor.addEntity(&allocators->Bullet_allocator, "Bullet", G_PHYSBALL_BULLET, true, nullptr, nullptr);
+    allocators->types.player = core->executor.addEntity(&allocators->Player_allocator, "Player", G_PHYSBALL_PLAYER, true, nullptr, nullptr);
+    allocators->types.enemy = core->executor.addEntity(&allocators->Enemy_allocator, "Enemy", G_PHYSBALL_ENEMY, true, nullptr, nullptr);
+    allocators->types.ring = core->executor.addEntity(&allocators->Ring_allocator, "Ring", G_GFXBALL_RING, true, nullptr, nullptr);
+    allocators->types.shrinkparticle = core->executor.addEntity(&allocators->ShrinkParticle_allocator, "ShrinkParticle", G_GFXBALL_SHRINKPARTICLE, true, nullptr, nullptr);
+
+    // reuse the most frequently spawned Entities (with their Quads and Spheres) instead of reallocating them
+    core->executor.setRecycle("Bullet", true);
+    core->executor.setRecycle("ShrinkParticle", true);
+
+    // every Entity runs each frame until killed, so keep them on their queues instead of re-enqueueing them
+    core->executor.setPersistent("Bullet", true);
+    core->executor.setPersistent("Player", true);
+    core->executor.setPersistent("Enemy", true);
+    core->executor.setPersistent("Ring", true);
+    core->executor.setPersistent("ShrinkParticle", true);
 }
 
 void gameInitialize(CoreResources *core, GlobalState *globalstate, Allocators *allocators) {
-    core->executor.enqueueSpawnEntity("Ring", 0, -1, Transform{});
+    core->executor.enqueueSpawnEntity(allocators->types.ring, 0, -1, Transform{});
 
-    TextConfig largefont{0, 0, 2, 5, 19, 7, 24, 0, 0, 1};
-    TextConfig smallfont{0, 0, 3, 5, 19, 5, 10, 0, 0, 1};
+    unsigned largefont = core->textenv.addFont(TextConfig{0, 0, 2, 5, 19, 7, 24, 0, 0, 1});
+    unsigned smallfont = core->textenv.addFont(TextConfig{0, 0, 3, 5, 19, 5, 10, 0, 0, 1});
     
-    globalstate->toptext.setTextConfig(largefont);
-    globalstate->toptext.setPos(glm::vec3(0.0f, 96.0f, 1.0f));
+    globalstate->toptext = core->textenv.genText(largefont);
+    core->textenv.setPos(globalstate->toptext, glm::vec3(0.0f, 96.0f, 1.0f));
 
-    globalstate->subtext.setTextConfig(smallfont);
-    globalstate->subtext.setPos(glm::vec3(0.0f, 80.0f, 1.0f));
+    globalstate->subtext = core->textenv.genText(smallfont);
+    core->textenv.setPos(globalstate->subtext, glm::vec3(0.0f, 80.0f, 1.0f));
 
-    globalstate->bottomtext.setTextConfig(smallfont);
-    globalstate->bottomtext.setPos(glm::vec3(0.0f, -80.0f, 1.0f));
+    globalstate->bottomtext = core->textenv.genText(smallfont);
+    core->textenv.setPos(globalstate->bottomtext, glm::vec3(0.0f, -80.0f, 1.0f));
     
     /* 
     0: game start
@@ -112,7 +125,7 @@ void gameStep(CoreResources *core, GlobalState *globalstate, Allocators *allocat
 
         // spawn a player if none exist
         if (allocators->Player_provider.getProvidedCount() == 0) {
-            core->executor.enqueueSpawnEntity("Player", 0, -1, Transform{});
+            core->executor.enqueueSpawnEntity(allocators->types.player, 0, -1, Transform{});
         }
 
         // check for input to start game if at least one player is spawned
@@ -165,7 +178,7 @@ void gameStep(CoreResources *core, GlobalState *globalstate, Allocators *allocat
 
                     // get random size factor, and store factor
                     int size_factor = int(float(rand() % globalstate->round) / 4.0f);
-                    core->executor.enqueueSpawnEntity("Enemy", 0, 65536, Transform{spawn_vec1 + spawn_vec2, glm::vec3(12.0f + (2.0f * float(size_factor)))});
+                    core->executor.enqueueSpawnEntity(allocators->types.enemy, 0, 65536, Transform{spawn_vec1 + spawn_vec2, glm::vec3(12.0f + (2.0f * float(size_factor)))});
                     globalstate->size_factors.push(size_factor);
                 }
             }
@@ -182,7 +195,7 @@ void gameStep(CoreResources *core, GlobalState *globalstate, Allocators *allocat
 
         // respawn player if somehow got here and there are no players
         if (allocators->Player_provider.getProvidedCount() == 0) {
-            core->executor.enqueueSpawnEntity("Player", 0, -1, Transform{});
+            core->executor.enqueueSpawnEntity(allocators->types.player, 0, -1, Transform{});
         } 
 
         // check for input to start next round if at least one player is spawned
@@ -212,24 +225,24 @@ void gameStep(CoreResources *core, GlobalState *globalstate, Allocators *allocat
 
     switch (globalstate->game_state) {
         case 0: 
-            globalstate->toptext.setText("Ball Game");
-            globalstate->subtext.setText("");
-            globalstate->bottomtext.setText("Press ENTER to start the game.");
+            core->textenv.setText(globalstate->toptext, "Ball Game");
+            core->textenv.setText(globalstate->subtext, "");
+            core->textenv.setText(globalstate->bottomtext, "Press ENTER to start the game.");
             break;
         case 1:
-            globalstate->toptext.setText((std::string("Round ") + std::to_string(globalstate->round)).c_str());
-            globalstate->subtext.setText((std::string("Goal: ") + stream.str() + std::string("%")).c_str());
-            globalstate->bottomtext.setText("");
+            core->textenv.setText(globalstate->toptext, (std::string("Round ") + std::to_string(globalstate->round)).c_str());
+            core->textenv.setText(globalstate->subtext, (std::string("Goal: ") + stream.str() + std::string("%")).c_str());
+            core->textenv.setText(globalstate->bottomtext, "");
             break;
         case 2:
-            globalstate->toptext.setText((std::string("Round ") + std::to_string(globalstate->round) + std::string(" complete!")).c_str());
-            globalstate->subtext.setText((std::string("Goal: ") + stream.str() + std::string("%")).c_str());
-            globalstate->bottomtext.setText("Press ENTER to start the next round.");
+            core->textenv.setText(globalstate->toptext, (std::string("Round ") + std::to_string(globalstate->round) + std::string(" complete!")).c_str());
+            core->textenv.setText(globalstate->subtext, (std::string("Goal: ") + stream.str() + std::string("%")).c_str());
+            core->textenv.setText(globalstate->bottomtext, "Press ENTER to start the next round.");
             break;
         case 3:
-            globalstate->toptext.setText((std::string("Round ") + std::to_string(globalstate->round) + std::string(" failed.")).c_str());
-            globalstate->subtext.setText((std::string("Goal: ") + stream.str() + std::string("%")).c_str());
-            globalstate->bottomtext.setText("Press ENTER to return to title.");
+            core->textenv.setText(globalstate->toptext, (std::string("Round ") + std::to_string(globalstate->round) + std::string(" failed.")).c_str());
+            core->textenv.setText(globalstate->subtext, (std::string("Goal: ") + stream.str() + std::string("%")).c_str());
+            core->textenv.setText(globalstate->bottomtext, "Press ENTER to return to title.");
             break;
         default:
             break;
@@ -251,6 +264,9 @@ void gameProcess(CoreResources *core, GlobalState *state, Allocators *allocators
     core->sphere_space.resetCollidedCount();
     core->sphere_space.detectCollision();
 
+    // advance animations of Quads
+    core->glenv.stepAnims();
+
     // spawn anything enqueued by previous step
     core->executor.runSpawnQueue();
 
@@ -265,14 +281,11 @@ void gameProcess(CoreResources *core, GlobalState *state, Allocators *allocators
     // kill
     core->executor.runKillQueue();
     
-    // text updates
-    state->toptext.update();
-    state->subtext.update();
-    state->bottomtext.update();
-    
-    // graphics updates and draw
+    // graphics updates and draw (text over the upscaled Quads)
     core->glenv.update();
+    core->textenv.update();
     core->glenv.drawQuads();
+    core->textenv.drawText();
 
     glfwSwapBuffers(core->state.getWindowHandle());
 }
\ No newline at end of file
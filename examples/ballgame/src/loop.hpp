@@ -3,7 +3,6 @@
 
 #include "coreinit.hpp"
 #include "allocators.hpp"
-#include "../../../core/include/text.hpp"
 
 #include <iostream>
 #include <chrono>
@@ -12,6 +11,8 @@
 #include <thread>
 
 struct Allocators {
+    // handles of the added Entity names, set by addAllocators()
+    EntityTypes types;
     BulletAllocator Bullet_allocator;
     PlayerAllocator Player_allocator;
     EnemyAllocator Enemy_allocator;
@@ -44,12 +45,12 @@ struct GlobalState : public Receiver<Enemy> {
 
     bool killflag;
 
-    Text toptext;
-    Text subtext;
-    Text bottomtext;
+    // TextEnv string offsets
+    unsigned toptext;
+    unsigned subtext;
+    unsigned bottomtext;
 
-    // need this to initialize Text members
-    GlobalState(GLEnv *glenv);
+    GlobalState();
 
     std::queue<int> size_factors;
 
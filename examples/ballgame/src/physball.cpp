@@ -1,10 +1,17 @@
 #include "physball.hpp"
 
 void PhysBall::_initEntity() {
-    // create and set quad and box
-    _quad_off = executor().glenv().genQuad(transform.pos, transform.scale, glm::vec4(1.0f), glm::vec3(0.0f), glm::vec2(0.0f), GLE_ELLIPSE);
-    _quad = executor().glenv().getQuad(_quad_off);
-    _sphere = executor().spherespace().push(transform, glm::vec3(0.0f), nullptr);
+    // create and set quad and box, or set the ones kept from a previous spawn if recycled
+    if (!_quad) {
+        _quad_off = executor().glenv().genQuad(transform.pos, transform.scale, glm::vec4(1.0f), glm::vec3(0.0f), glm::vec2(0.0f), GLE_ELLIPSE);
+        _quad = executor().glenv().getQuad(_quad_off);
+        _sphere = executor().spherespace().push(transform, glm::vec3(0.0f), nullptr);
+    } else {
+        _quad->setPos(transform.pos);
+        _quad->setScale(transform.scale);
+        _quad->setColor(glm::vec4(1.0f));
+        _sphere->transform = transform;
+    }
     _sphere->radius = transform.scale.x / 2.0f;
 
     // set animation and filter if they are named
@@ -24,30 +31,56 @@ void PhysBall::_baseEntity() {
     transform.pos += vel;
     _sphere->transform = transform;
     _sphere->radius = transform.scale.x / 2.0f;
-    _quad->bv_pos.v = glm::vec3(transform.pos.x, transform.pos.y, _quad->bv_pos.v.z);
-    _quad->bv_scale.v = transform.scale;
+    _quad->setPos(glm::vec3(transform.pos.x, transform.pos.y, _quad->getPos().z));
+    _quad->setScale(transform.scale);
 
     _quad->stepAnim();
 
-    // only queue if not set to be killed
-    if (!getKillEnqueued())
+    // only queue if not set to be killed, and not already run every execution
+    if (!getKillEnqueued() && !getPersistent())
         enqueueExec(getLastExecQueue());
 }
 
 void PhysBall::_killEntity() {
-    executor().glenv().remove(_quad_off);
-    executor().spherespace().erase(_sphere);
+    // keep quad and sphere for the next spawn if recycled, hiding them (animations would override the scale) and 
+    // excluding the sphere from collision
+    if (getRecycle()) {
+        _quad->setAnim(nullptr);
+        _quad->setScale(glm::vec3(0.0f));
+        _sphere->transform.scale = glm::vec3(0.0f);
+    } else {
+        executor().glenv().remove(_quad_off);
+        executor().spherespace().erase(_sphere);
+    }
 
     _killPhysBall();
 }
 
+void PhysBall::_resetEntity() {
+    vel = glm::vec3(0.0f);
+
+    _resetPhysBall();
+}
+
+void PhysBall::_releaseEntity() {
+    // release the quad and sphere kept while recycled (if it was killed before being initialized, there are none)
+    if (!_quad)
+        return;
+    executor().glenv().remove(_quad_off);
+    executor().spherespace().erase(_sphere);
+    _quad = nullptr;
+    _sphere = nullptr;
+}
+
 void PhysBall::_initPhysBall() {}
 void PhysBall::_basePhysBall() {}
 void PhysBall::_killPhysBall() {}
+void PhysBall::_resetPhysBall() {}
 
 PhysBall::PhysBall(std::string animation_name, std::string filter_name) : 
     Entity(), 
     _quad(nullptr),
+    _quad_off(0),
     _sphere(nullptr),
     _animation_name(animation_name),
     _filter_name(filter_name),
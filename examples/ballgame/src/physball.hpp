@@ -14,11 +14,14 @@ class PhysBall : public Entity {
     void _initEntity() override;
     void _baseEntity() override;
     void _killEntity() override;
+    void _resetEntity() override;
+    void _releaseEntity() override;
 
 protected:
     virtual void _initPhysBall();
     virtual void _basePhysBall();
     virtual void _killPhysBall();
+    virtual void _resetPhysBall();
 
 public:
     PhysBall(std::string animation_name, std::string filter_name);
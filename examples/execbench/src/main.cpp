@@ -0,0 +1,123 @@
+#include <chrono>
+#include <iostream>
+#include <queue>
+#include "../../../core/include/script.hpp"
+
+const unsigned SCRIPT_COUNTS[] = { 10000, 100000 };
+const unsigned WARMUP_TICKS = 10;
+const unsigned TICKS = 200;
+
+/* class TickScript
+   Script that re-enqueues itself every time it runs, as Entities in the examples do to stay alive, unless it is
+   persistent.
+*/
+class TickScript : public Script {
+    void _init() override {}
+    void _base() override {
+        ticks++;
+        if (!getPersistent())
+            enqueueExec(getLastExecQueue());
+    }
+    void _kill() override {}
+
+public:
+    unsigned ticks = 0;
+};
+
+/* struct Ticker
+   Object with a virtual tick, used to measure the cost of the queue containers alone, apart from the Executor.
+*/
+struct Ticker {
+    unsigned ticks = 0;
+    virtual ~Ticker() {}
+    virtual void tick() { ticks++; }
+};
+
+// runs ticks of self re-enqueueing (or persistent) Scripts on an Executor, and returns the average time per Script
+// per tick in nanoseconds
+double runExecutor(unsigned count, bool persistent) {
+    PooledAllocator<TickScript> allocator;
+    Executor executor(1);
+    ScriptType type = executor.add(&allocator, "TickScript", 0, true, nullptr, nullptr);
+    executor.setPersistent("TickScript", persistent);
+
+    for (unsigned i = 0; i < count; i++)
+        executor.enqueueSpawn(type, 0, -1);
+    executor.runSpawnQueue();
+
+    std::chrono::steady_clock::time_point start;
+    for (unsigned tick = 0; tick < WARMUP_TICKS + TICKS; tick++) {
+        if (tick == WARMUP_TICKS)
+            start = std::chrono::steady_clock::now();
+        executor.runExecQueue(0);
+    }
+    double elapsed = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+
+    if (executor.getCount() != count)
+        throw std::runtime_error("Attempt to benchmark with Scripts lost during ticks");
+    return elapsed / (double(TICKS) * count);
+}
+
+// runs ticks of Tickers re-enqueued through a pair of swapped std::queues (as Executors previously queued Scripts),
+// and returns the average time per Ticker per tick in nanoseconds
+double runQueueReference(unsigned count) {
+    std::vector<Ticker> tickers(count);
+    std::queue<Ticker*> push_queue;
+    std::queue<Ticker*> run_queue;
+    for (Ticker &ticker : tickers)
+        push_queue.push(&ticker);
+
+    std::chrono::steady_clock::time_point start;
+    for (unsigned tick = 0; tick < WARMUP_TICKS + TICKS; tick++) {
+        if (tick == WARMUP_TICKS)
+            start = std::chrono::steady_clock::now();
+
+        run_queue.swap(push_queue);
+        while (!run_queue.empty()) {
+            Ticker *ticker = run_queue.front();
+            ticker->tick();
+            push_queue.push(ticker);
+            run_queue.pop();
+        }
+    }
+    double elapsed = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+
+    return elapsed / (double(TICKS) * count);
+}
+
+// runs the same ticks through a pair of swapped std::vectors (as Executors now queue Scripts)
+double runVectorReference(unsigned count) {
+    std::vector<Ticker> tickers(count);
+    std::vector<Ticker*> push_queue;
+    std::vector<Ticker*> run_queue;
+    for (Ticker &ticker : tickers)
+        push_queue.push_back(&ticker);
+
+    std::chrono::steady_clock::time_point start;
+    for (unsigned tick = 0; tick < WARMUP_TICKS + TICKS; tick++) {
+        if (tick == WARMUP_TICKS)
+            start = std::chrono::steady_clock::now();
+
+        run_queue.swap(push_queue);
+        for (Ticker *ticker : run_queue) {
+            ticker->tick();
+            push_queue.push_back(ticker);
+        }
+        run_queue.clear();
+    }
+    double elapsed = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+
+    return elapsed / (double(TICKS) * count);
+}
+
+int main() {
+    for (unsigned count : SCRIPT_COUNTS) {
+        std::cout << count << " scripts, " << TICKS << " ticks (ns per script per tick):" << std::endl;
+        std::cout << "  executor: " << runExecutor(count, false) << std::endl;
+        std::cout << "  executor (persistent): " << runExecutor(count, true) << std::endl;
+        std::cout << "  std::queue buffers alone: " << runQueueReference(count) << std::endl;
+        std::cout << "  std::vector buffers alone: " << runVectorReference(count) << std::endl;
+    }
+
+    return 0;
+}
@@ -0,0 +1,113 @@
+#include <chrono>
+#include <cmath>
+#include "../../../core/include/eglstate.hpp"
+#include "../../../core/include/glenv.hpp"
+
+const unsigned WINDOW_WIDTH = 512;
+const unsigned WINDOW_HEIGHT = 512;
+const unsigned PIXEL_WIDTH = WINDOW_WIDTH / 2;
+const unsigned PIXEL_HEIGHT = WINDOW_HEIGHT / 2;
+const unsigned PIXEL_LEVELS = 16;
+
+const unsigned QUAD_COUNT = 10000;
+const unsigned WARMUP_FRAMES = 30;
+const unsigned FRAMES = 300;
+
+/* struct BenchConfig
+   GLEnv flags to run the benchmark with, and the name to report them under.
+*/
+struct BenchConfig {
+    const char *name;
+    unsigned flags;
+};
+
+const BenchConfig CONFIGS[] = {
+    { "default", GLE_NONE },
+    { "persistent", GLE_PERSISTENT },
+    { "persistent packed", GLE_PERSISTENT | GLE_PACKED },
+    { "persistent packed offscreen", GLE_PERSISTENT | GLE_PACKED | GLE_OFFSCREEN },
+    { "persistent packed layered", GLE_PERSISTENT | GLE_PACKED | GLE_LAYERED }
+};
+
+// renders frames of moving Quads with the provided flags, and returns the average time per frame in milliseconds;
+// egl is null under the null backend, and frame_log is set to the commands logged in the last frame
+double runConfig(EGLState *egl, unsigned flags, GLUtil::GLCommandLog &frame_log) {
+    GLEnv glenv(QUAD_COUNT, flags);
+    glenv.setTexArray(64, 64, 1);
+    float halfwidth = float(PIXEL_WIDTH) / 2.0f;
+    float halfheight = float(PIXEL_HEIGHT) / 2.0f;
+    glenv.setView(glm::lookAt(glm::vec3(0.0f, 0.0f, 1.0f), glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3(0.0f, 1.0f, 0.0f)));
+    glenv.setProj(glm::ortho(-1.0f * halfwidth, halfwidth, -1.0f * halfheight, halfheight, 0.0f, float(PIXEL_LEVELS)));
+    glenv.setWindowSpace(WINDOW_WIDTH, WINDOW_HEIGHT);
+    glenv.setPixelSpace(PIXEL_WIDTH, PIXEL_HEIGHT, PIXEL_LEVELS);
+
+    // layers are resolved by depth testing
+    if (egl) {
+        if (flags & GLE_LAYERED)
+            glEnable(GL_DEPTH_TEST);
+        else
+            glDisable(GL_DEPTH_TEST);
+    }
+
+    // half rectangles and half ellipses, spread over pixel space and layers
+    std::vector<unsigned> offsets;
+    for (unsigned i = 0; i < QUAD_COUNT; i++) {
+        glm::vec3 pos(float(i % PIXEL_WIDTH) - halfwidth, float(i / PIXEL_WIDTH % PIXEL_HEIGHT) - halfheight, -float(i % 4) - 1.0f);
+        DrawType type = (i % 2) ? GLE_ELLIPSE : GLE_RECT;
+        offsets.push_back(glenv.genQuad(pos, glm::vec3(8.0f), glm::vec4(1.0f), glm::vec3(0.0f), glm::vec2(8.0f), type));
+    }
+
+    std::chrono::steady_clock::time_point start;
+    for (unsigned frame = 0; frame < WARMUP_FRAMES + FRAMES; frame++) {
+        if (frame == WARMUP_FRAMES)
+            start = std::chrono::steady_clock::now();
+        GLUtil::commandLog().clear();
+
+        // move every Quad, so that every position is written each frame
+        for (unsigned offset : offsets) {
+            Quad *quad = glenv.getQuad(offset);
+            glm::vec3 pos = quad->getPos();
+            pos.x = std::fmod(pos.x + 1.0f + halfwidth, float(PIXEL_WIDTH)) - halfwidth;
+            quad->setPos(pos);
+        }
+
+        GLUtil::bindDefaultFramebuffer();
+        GLUtil::clear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+        glenv.update();
+        glenv.drawQuads();
+        if (egl)
+            egl->finish();
+    }
+    frame_log = GLUtil::commandLog();
+
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() / FRAMES;
+}
+
+int main(int argc, char *argv[]) {
+    // time only the CPU side of submission, without a driver, if requested
+    if (argc > 1 && std::string(argv[1]) == "null") {
+        std::cout << "Using null backend" << std::endl;
+        GLUtil::setBackend(GLUtil::GLU_NULL);
+        for (const BenchConfig &config : CONFIGS) {
+            GLUtil::GLCommandLog frame_log;
+            double frame_ms = runConfig(nullptr, config.flags, frame_log);
+            std::cout << config.name << ": " << QUAD_COUNT << " quads, " << frame_ms << " ms/frame; commands per frame:" << std::endl;
+            frame_log.print(std::cout);
+        }
+        return 0;
+    }
+
+    std::cout << "Setting up EGLState" << std::endl;
+    EGLState egl(WINDOW_WIDTH, WINDOW_HEIGHT, false);
+    GLUtil::glinit(false);
+    egl.initTarget();
+    std::cout << "Renderer: " << glGetString(GL_RENDERER) << (egl.isSurfaceless() ? " (surfaceless)" : " (pbuffer)") << std::endl;
+
+    for (const BenchConfig &config : CONFIGS) {
+        GLUtil::GLCommandLog frame_log;
+        double frame_ms = runConfig(&egl, config.flags, frame_log);
+        std::cout << config.name << ": " << QUAD_COUNT << " quads, " << frame_ms << " ms/frame" << std::endl;
+    }
+
+    return 0;
+}